@@ -0,0 +1,686 @@
+// microbenchmarks for the collision and rope code. prints one JSON object with a result per benchmark:
+//
+//     umihara_bench [--filter <substring>] [--min-time <seconds>] [--repetitions <n>]
+//                   [--save-baseline <file>] [--compare <file>] [--threshold <percent>]
+//                   [--replay <file or directory>]...
+//
+// each benchmark is timed repetitions times and reported as the median with a 95% confidence interval.
+// --save-baseline writes the results to a file for a later run to --compare against; the comparison
+// exits with 1 if any of TRACKED_BENCHMARKS got more than threshold percent slower.
+//
+// --replay plays input recordings (from the game's --record, or the ones in bench/replays) back through
+// the whole of gameUpdate, as fast as it will go, instead of the microbenchmarks. each recording's level
+// is loaded from the levels directory next to it. the replays share one game; each level's storage is
+// trimmed to fit when it loads, but memory_bytes still carries over pivot capacity earlier ropes grew
+
+#include <algorithm>
+#include <cmath>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+#ifdef __APPLE__
+#include <SDL2_ttf/SDL_ttf.h>
+#endif
+
+#ifdef __linux__
+#include <SDL2/SDL_ttf.h>
+#endif
+
+#ifdef _WIN64
+#include <SDL_ttf.h>
+#endif
+
+#include "../src/game.hpp"
+#include "../src/replay.hpp"
+#include "../src/level.hpp"
+#include "../src/player.hpp"
+#include "../src/grapple.hpp"
+#include "../src/controls.hpp"
+#include "../src/allocations.hpp"
+#include "../src/filewriter.hpp"
+#include "../src/memory.hpp"
+#include "../src/generator.hpp"
+using namespace std;
+
+// each benchmark runs at least this long, doubling the iterations until it does
+const double DEFAULT_MIN_TIME = 0.25;
+const long long MAX_ITERATIONS = 1LL << 30;
+
+const int DEFAULT_REPETITIONS = 5;
+const double DEFAULT_THRESHOLD = 10;
+
+// the hot paths a comparison fails on. everything else is only reported
+const int NUMBER_OF_TRACKED_BENCHMARKS = 5;
+const string TRACKED_BENCHMARKS[NUMBER_OF_TRACKED_BENCHMARKS] = {
+    "Player::update/100000",
+    "Rope::update/pivots:50",
+    "Rope::collideCorners/10000",
+    "GrappleSeeker::seek/10000",
+    "checkLineRectCollision/hit"
+};
+
+// level sizes, in platforms, for everything that scans the whole level
+const int NUMBER_OF_LEVEL_SIZES = 4;
+const int LEVEL_SIZES[NUMBER_OF_LEVEL_SIZES] = { 100, 1000, 10000, 100000 };
+
+const int NUMBER_OF_PIVOT_COUNTS = 4;
+const int PIVOT_COUNTS[NUMBER_OF_PIVOT_COUNTS] = { 0, 10, 50, 100 };
+
+// levels are generated as corridors ROW_LENGTH tiles wide, with floors ROW_SPACING tiles apart and a
+// one tile shaft through each. the player starts on the top floor with nothing above, so ropes and
+// seekers have open air to work in
+const int ROW_LENGTH = 200;
+const int ROW_SPACING = 8;
+const Uint64 BENCH_LEVEL_SEED = 1;
+
+// results are added up into this so the compiler can't throw the work away
+static volatile double sink = 0;
+
+// static, since game.cpp is linked in and has its own level and player
+static Level *level = NULL;
+static Player *player = NULL;
+static Rope *rope = NULL;
+static GrappleSeeker *seeker = NULL;
+static KeyboardLayout keys;
+
+// platforms the rope benchmarks hang their pivots on. they aren't part of the level, so nothing collides with them
+static Platform pivotPlatforms[128];
+static int numberOfPivots = 0;
+
+struct BenchmarkResult {
+    string name;
+    
+    // median and confidence interval, in nanoseconds per iteration
+    double nsPerOp;
+    double low;
+    double high;
+};
+
+static string filter;
+static double minTime = DEFAULT_MIN_TIME;
+static int repetitions = DEFAULT_REPETITIONS;
+static double threshold = DEFAULT_THRESHOLD;
+
+static vector<BenchmarkResult> results;
+
+// everything printed, for --save-baseline
+static string output;
+
+// about numberOfPlatforms platforms: the shafts take one from every floor but the last
+bool buildLevel(Level *level, int numberOfPlatforms) {
+    LevelGeneratorSettings settings;
+    setDefaultGeneratorSettings(&settings);
+    
+    // only floors; the rows between corridors are left empty
+    int floors = (numberOfPlatforms + ROW_LENGTH - 1) / ROW_LENGTH;
+    settings.width = max(min(numberOfPlatforms, ROW_LENGTH), MAP_WIDTH);
+    settings.height = max(floors * ROW_SPACING, MAP_HEIGHT);
+    settings.density = 0;
+    settings.corridorHeight = ROW_SPACING - 2;
+    settings.corridorSpacing = ROW_SPACING;
+    settings.shaftWidth = 1;
+    settings.seed = BENCH_LEVEL_SEED;
+    
+    return generateLevel(level, &settings);
+}
+
+// a fresh player each time, since the old one may still point at the last level's platforms.
+// the rope and seeker belong to the old player, so they go too
+void placePlayer() {
+    delete seeker;
+    seeker = NULL;
+    delete rope;
+    rope = NULL;
+    
+    delete player;
+    player = new Player();
+    
+    player->setPos(level->getStartX(), level->getStartY());
+    player->stop();
+}
+
+double getPlayerCenterX() {
+    return player->getX() + player->getWidth() / 2;
+}
+
+double getPlayerCenterY() {
+    return player->getY() + player->getHeight() / 2;
+}
+
+// a rope hanging from open air above the player, wrapped around count pivots on the way
+void buildRope(int count) {
+    delete rope;
+    rope = new Rope(player, getPlayerCenterX(), getPlayerCenterY() - MAX_ROPE_LENGTH);
+    
+    for (int i = 0; i < count; i++) {
+        // zig-zag down towards the player
+        int x = getPlayerCenterX() + ((i % 2) ? 40 : -40 - PLATFORM_WIDTH);
+        int y = getPlayerCenterY() - MAX_ROPE_LENGTH + 8 + i * (MAX_ROPE_LENGTH - 48) / max(count, 1);
+        
+        pivotPlatforms[i] = Platform(x, y, 8, 8, NORMAL);
+        rope->addPivot(pivotPlatforms + i, i % 2 ? TOP_LEFT : TOP_RIGHT);
+    }
+    
+    numberOfPivots = count;
+}
+
+void setUpKeys() {
+    keys.setUp(-1);
+    keys.setDown(-1);
+    keys.setLeft(-1);
+    keys.setRight(-1);
+    keys.setConfirm(-1);
+    keys.setBack(-1);
+    keys.setPause(-1);
+    keys.setJump(-1);
+    keys.setGrapple(-1);
+    keys.setAirBlast(-1);
+    keys.setReset(-1);
+    keys.setNextEditorMode(-1);
+    keys.setPreviousEditorMode(-1);
+    keys.setNextPlatformType(-1);
+    keys.setPreviousPlatformType(-1);
+    keys.setPlayToggle(-1);
+    
+    // nothing is bound, so every key reads as NONE
+    Uint8 state[SDL_NUM_SCANCODES] = { 0 };
+    keys.update(state);
+}
+
+void benchLineRectHit(long long iterations) {
+    CollisionReportContainer collisions;
+    for (long long i = 0; i < iterations; i++) {
+        getLineRectangleCollision(0, 0, 100, 90, 40, 40, PLATFORM_WIDTH, PLATFORM_HEIGHT, &collisions);
+        sink = sink + collisions.getNumberOfReports();
+    }
+}
+
+void benchLineRectMiss(long long iterations) {
+    CollisionReportContainer collisions;
+    for (long long i = 0; i < iterations; i++) {
+        getLineRectangleCollision(0, 0, 100, 10, 40, 40, PLATFORM_WIDTH, PLATFORM_HEIGHT, &collisions);
+        sink = sink + collisions.getNumberOfReports();
+    }
+}
+
+void benchCheckLineRectHit(long long iterations) {
+    for (long long i = 0; i < iterations; i++) {
+        sink = sink + checkLineRectCollision(0, 0, 100, 90, 40, 40, PLATFORM_WIDTH, PLATFORM_HEIGHT);
+    }
+}
+
+void benchCheckLineRectMiss(long long iterations) {
+    for (long long i = 0; i < iterations; i++) {
+        sink = sink + checkLineRectCollision(0, 0, 100, 10, 40, 40, PLATFORM_WIDTH, PLATFORM_HEIGHT);
+    }
+}
+
+// one step of a seeker fired straight up into open air. it extends, comes back and is fired again,
+// reset the way the player reuses its own
+void benchSeek(long long iterations) {
+    if (!seeker) {
+        seeker = new GrappleSeeker(player, -M_PI_2);
+    }
+    
+    for (long long i = 0; i < iterations; i++) {
+        if (seeker->seek(level)) {
+            seeker->reset(-M_PI_2);
+        }
+    }
+}
+
+void benchCollideCorners(long long iterations) {
+    for (long long i = 0; i < iterations; i++) {
+        sink = sink + rope->collideCorners(level);
+    }
+}
+
+void benchRopeUpdate(long long iterations) {
+    for (long long i = 0; i < iterations; i++) {
+        // update can unwrap the last pivots, so put them back each time
+        rope->setNumberOfPivots(numberOfPivots);
+        sink = sink + rope->update(level);
+    }
+}
+
+// a player standing still on the floor, which still tests every platform in the level
+void benchPlayerUpdate(long long iterations) {
+    for (long long i = 0; i < iterations; i++) {
+        sink = sink + player->update(&keys, level);
+    }
+}
+
+double getSeconds(Uint64 ticks) {
+    return static_cast<double>(ticks) / SDL_GetPerformanceFrequency();
+}
+
+void print(const char *text) {
+    printf("%s", text);
+    fflush(stdout);
+    
+    output += text;
+}
+
+// a 95% confidence interval for the median from the sorted samples' order statistics, so it doesn't
+// assume the timings are normally distributed. with fewer than 6 samples it's the whole range
+void getMedianInterval(vector<double> *sorted, double *low, double *high) {
+    int n = static_cast<int>(sorted->size());
+    double spread = 0.98 * sqrt(n);
+    
+    *low = (*sorted)[max(0, static_cast<int>(floor(n / 2.0 - spread)))];
+    *high = (*sorted)[min(n - 1, static_cast<int>(ceil(n / 2.0 + spread)))];
+}
+
+// items is how much work one iteration does (platforms tested, say), for the throughput figure
+void runBenchmark(string name, void (*benchmark)(long long iterations), double items) {
+    if (!filter.empty() && name.find(filter) == string::npos) {
+        return;
+    }
+    
+    // warm up, and let the benchmark make anything it only makes once
+    benchmark(1);
+    
+    long long iterations = 1;
+    Uint64 elapsed = 0;
+    Uint64 allocations = 0;
+    
+    while (true) {
+        Uint64 allocationsBefore = getThreadAllocations();
+        Uint64 start = SDL_GetPerformanceCounter();
+        
+        benchmark(iterations);
+        
+        elapsed = SDL_GetPerformanceCounter() - start;
+        allocations = getThreadAllocations() - allocationsBefore;
+        
+        if (getSeconds(elapsed) >= minTime || iterations >= MAX_ITERATIONS) {
+            break;
+        }
+        
+        // aim a little past the minimum, but don't jump more than tenfold on a noisy short run
+        double scale = getSeconds(elapsed) > 0 ? minTime * 1.2 / getSeconds(elapsed) : 10;
+        iterations = static_cast<long long>(iterations * max(2.0, min(scale, 10.0)));
+    }
+    
+    // the run that met the minimum time is the first sample
+    vector<double> samples;
+    samples.push_back(getSeconds(elapsed) * 1e9 / iterations);
+    
+    for (int i = 1; i < repetitions; i++) {
+        Uint64 start = SDL_GetPerformanceCounter();
+        benchmark(iterations);
+        samples.push_back(getSeconds(SDL_GetPerformanceCounter() - start) * 1e9 / iterations);
+    }
+    
+    sort(samples.begin(), samples.end());
+    
+    BenchmarkResult result;
+    result.name = name;
+    result.nsPerOp = samples.size() % 2 ? samples[samples.size() / 2] : (samples[samples.size() / 2 - 1] + samples[samples.size() / 2]) / 2;
+    getMedianInterval(&samples, &result.low, &result.high);
+    
+    double opsPerSecond = 1e9 / result.nsPerOp;
+    
+    char line[512];
+    snprintf(line, sizeof(line), "%s\n    { \"name\": \"%s\", \"iterations\": %lld, \"repetitions\": %d, \"ns_per_op\": %.2f, \"ci_low\": %.2f, \"ci_high\": %.2f, \"allocs_per_op\": %.3f, \"ops_per_sec\": %.1f, \"items_per_op\": %.0f, \"items_per_sec\": %.1f }",
+             results.empty() ? "" : ",", name.c_str(), iterations, repetitions, result.nsPerOp, result.low, result.high, static_cast<double>(allocations) / iterations, opsPerSecond, items, opsPerSecond * items);
+    print(line);
+    
+    results.push_back(result);
+}
+
+// every recording in a directory, in name order, or just the file
+void findReplays(string path, vector<string> *replays) {
+    filesystem::path replayPath = filesystem::absolute(path);
+    
+    if (!filesystem::is_directory(replayPath)) {
+        replays->push_back(replayPath.string());
+        return;
+    }
+    
+    vector<string> found;
+    error_code error;
+    for (filesystem::directory_iterator i(replayPath, error); !error && i != filesystem::directory_iterator(); i.increment(error)) {
+        if (i->path().extension() == REPLAY_EXTENSION) {
+            found.push_back(i->path().string());
+        }
+    }
+    
+    sort(found.begin(), found.end());
+    replays->insert(replays->end(), found.begin(), found.end());
+}
+
+// one run of a recording from the start of its level, stopping early if it leaves the level.
+// tickTimes gets a time in milliseconds for every tick played
+bool playReplay(InputRecording *recording, vector<double> *tickTimes) {
+    // nothing is held going in, so the first tick's buttons read as PRESSED like they did when recorded
+    keys.updateButtons(0);
+    
+    if (!gameStartLevel(recording->getLevelName())) {
+        return false;
+    }
+    
+    char letters[MAX_QUEUED_LETTERS];
+    
+    for (int i = 0; i < recording->getNumberOfTicks() && gameIsPlayingLevelFile(); i++) {
+        keys.updateButtons(recording->getButtons(i));
+        
+        Uint64 start = SDL_GetPerformanceCounter();
+        gameUpdate(&keys, letters, 0);
+        tickTimes->push_back(getSeconds(SDL_GetPerformanceCounter() - start) * 1000);
+    }
+    
+    return true;
+}
+
+double getPercentile(vector<double> *sorted, double percentile) {
+    size_t i = static_cast<size_t>(ceil(percentile / 100 * sorted->size()));
+    return (*sorted)[min(sorted->size() - 1, i > 0 ? i - 1 : 0)];
+}
+
+bool runReplay(string filename) {
+    InputRecording recording;
+    if (!recording.load(filename)) {
+        return false;
+    }
+    
+    // the game looks for levels/ in the working directory
+    filesystem::current_path(filesystem::path(filename).parent_path());
+    
+    string name = "replay/" + filesystem::path(filename).stem().string();
+    if (!filter.empty() && name.find(filter) == string::npos) {
+        return true;
+    }
+    
+    // warm up, with the level's first load out of the way
+    vector<double> tickTimes;
+    if (!playReplay(&recording, &tickTimes)) {
+        return false;
+    }
+    tickTimes.clear();
+    
+    // each run's mean tick time is one sample for the median and its interval, like the microbenchmarks
+    vector<double> samples;
+    double totalTime = 0;
+    Uint64 allocationsBefore = getThreadAllocations();
+    
+    for (int i = 0; i < repetitions; i++) {
+        size_t ticksBefore = tickTimes.size();
+        playReplay(&recording, &tickTimes);
+        
+        double runTime = 0;
+        for (size_t j = ticksBefore; j < tickTimes.size(); j++) {
+            runTime += tickTimes[j];
+        }
+        
+        totalTime += runTime;
+        samples.push_back(runTime * 1e6 / max(static_cast<size_t>(1), tickTimes.size() - ticksBefore));
+    }
+    
+    Uint64 allocations = getThreadAllocations() - allocationsBefore;
+    
+    if (tickTimes.empty()) {
+        printf("Couldn't replay %s. Error: no ticks\n", filename.c_str());
+        return false;
+    }
+    
+    sort(samples.begin(), samples.end());
+    sort(tickTimes.begin(), tickTimes.end());
+    
+    BenchmarkResult result;
+    result.name = name;
+    result.nsPerOp = samples.size() % 2 ? samples[samples.size() / 2] : (samples[samples.size() / 2 - 1] + samples[samples.size() / 2]) / 2;
+    getMedianInterval(&samples, &result.low, &result.high);
+    
+    int ticks = static_cast<int>(tickTimes.size()) / repetitions;
+    
+    // what the level and the rope hold once the run is over. used_bytes is this level's own; memory_bytes
+    // also counts pivot capacity that replays before it grew the game's one rope and seeker to
+    MemoryReport memory;
+    gameReportMemory(&memory);
+    
+    char line[640];
+    snprintf(line, sizeof(line), "%s\n    { \"name\": \"%s\", \"level\": \"%s\", \"ticks\": %d, \"repetitions\": %d, \"ns_per_op\": %.2f, \"ci_low\": %.2f, \"ci_high\": %.2f, \"p50_ms\": %.4f, \"p90_ms\": %.4f, \"p99_ms\": %.4f, \"max_ms\": %.4f, \"allocs_per_tick\": %.3f, \"ticks_per_sec\": %.1f, \"used_bytes\": %zu, \"memory_bytes\": %zu, \"unused_bytes\": %zu }",
+             results.empty() ? "" : ",", name.c_str(), recording.getLevelName().c_str(), ticks, repetitions, result.nsPerOp, result.low, result.high,
+             getPercentile(&tickTimes, 50), getPercentile(&tickTimes, 90), getPercentile(&tickTimes, 99), tickTimes.back(),
+             static_cast<double>(allocations) / tickTimes.size(), tickTimes.size() * 1000 / totalTime,
+             memory.getTotalUsed(), memory.getTotalAllocated(), memory.getTotalAllocated() - memory.getTotalUsed());
+    print(line);
+    
+    results.push_back(result);
+    return true;
+}
+
+bool runReplays(vector<string> *replays) {
+    if (TTF_Init() < 0) {
+        printf("Couldn't initialize TTF. Error: %s\n", SDL_GetError());
+        return false;
+    }
+    
+    if (!gameInitHeadless()) {
+        return false;
+    }
+    
+    print("{\n  \"replays\": [");
+    
+    bool succeeded = true;
+    for (size_t i = 0; i < replays->size() && succeeded; i++) {
+        succeeded = runReplay((*replays)[i]);
+    }
+    
+    print("\n  ]\n}\n");
+    
+    gameCleanUp();
+    TTF_Quit();
+    
+    return succeeded;
+}
+
+// the number after "key": on a line of our own output, which has one benchmark per line
+bool readNumber(const char *line, const char *key, double *value) {
+    const char *found = strstr(line, key);
+    return found && sscanf(found + strlen(key), "%lf", value) == 1;
+}
+
+bool loadBaseline(string filename, vector<BenchmarkResult> *baseline) {
+    FILE *file = fopen(filename.c_str(), "r");
+    if (!file) {
+        printf("Couldn't open baseline %s\n", filename.c_str());
+        return false;
+    }
+    
+    char line[1024];
+    while (fgets(line, sizeof(line), file)) {
+        const char *name = strstr(line, "\"name\": \"");
+        if (!name) {
+            continue;
+        }
+        
+        name += strlen("\"name\": \"");
+        const char *nameEnd = strchr(name, '"');
+        
+        BenchmarkResult result;
+        if (!nameEnd || !readNumber(line, "\"ns_per_op\": ", &result.nsPerOp)) {
+            continue;
+        }
+        result.name = string(name, nameEnd - name);
+        
+        // baselines from before the repetitions have no interval
+        if (!readNumber(line, "\"ci_low\": ", &result.low) || !readNumber(line, "\"ci_high\": ", &result.high)) {
+            result.low = result.nsPerOp;
+            result.high = result.nsPerOp;
+        }
+        
+        baseline->push_back(result);
+    }
+    
+    fclose(file);
+    return true;
+}
+
+bool isTracked(string name) {
+    for (int i = 0; i < NUMBER_OF_TRACKED_BENCHMARKS; i++) {
+        if (TRACKED_BENCHMARKS[i] == name) {
+            return true;
+        }
+    }
+    
+    return false;
+}
+
+// the report goes to stderr so stdout stays plain JSON. returns false if a tracked benchmark regressed
+bool compareWithBaseline(vector<BenchmarkResult> *baseline) {
+    int regressions = 0;
+    
+    fprintf(stderr, "compared with the baseline (threshold %.1f%%):\n", threshold);
+    
+    for (size_t i = 0; i < results.size(); i++) {
+        BenchmarkResult *current = &results[i];
+        
+        BenchmarkResult *previous = NULL;
+        for (size_t j = 0; j < baseline->size(); j++) {
+            if ((*baseline)[j].name == current->name) {
+                previous = &(*baseline)[j];
+            }
+        }
+        
+        if (!previous) {
+            fprintf(stderr, "    %-32s not in the baseline\n", current->name.c_str());
+            continue;
+        }
+        
+        double change = (current->nsPerOp - previous->nsPerOp) * 100 / previous->nsPerOp;
+        
+        // slower by more than the threshold, and by more than the noise: the intervals don't overlap
+        bool regressed = change > threshold && current->low > previous->high;
+        bool tracked = isTracked(current->name);
+        
+        const char *verdict = "";
+        if (regressed) {
+            verdict = tracked ? "  REGRESSED" : "  slower (not tracked)";
+        } else if (change < -threshold && current->high < previous->low) {
+            verdict = "  faster";
+        }
+        
+        fprintf(stderr, "    %-32s %12.2f -> %12.2f ns  %+7.1f%%%s\n", current->name.c_str(), previous->nsPerOp, current->nsPerOp, change, verdict);
+        
+        if (regressed && tracked) {
+            regressions++;
+        }
+    }
+    
+    if (regressions > 0) {
+        fprintf(stderr, "%d tracked benchmark%s regressed by more than %.1f%%\n", regressions, regressions == 1 ? "" : "s", threshold);
+    }
+    
+    return regressions == 0;
+}
+
+bool runMicrobenchmarks();
+
+int main(int argc, char *argv[]) {
+    string baselineFilename;
+    string compareFilename;
+    vector<string> replays;
+    
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--filter") == 0 && i + 1 < argc) {
+            filter = argv[++i];
+        } else if (strcmp(argv[i], "--min-time") == 0 && i + 1 < argc) {
+            minTime = atof(argv[++i]);
+        } else if (strcmp(argv[i], "--repetitions") == 0 && i + 1 < argc) {
+            repetitions = max(1, atoi(argv[++i]));
+        } else if (strcmp(argv[i], "--save-baseline") == 0 && i + 1 < argc) {
+            baselineFilename = argv[++i];
+        } else if (strcmp(argv[i], "--compare") == 0 && i + 1 < argc) {
+            compareFilename = argv[++i];
+        } else if (strcmp(argv[i], "--threshold") == 0 && i + 1 < argc) {
+            threshold = atof(argv[++i]);
+        } else if (strcmp(argv[i], "--replay") == 0 && i + 1 < argc) {
+            findReplays(argv[++i], &replays);
+        } else {
+            printf("usage: %s [--filter <substring>] [--min-time <seconds>] [--repetitions <n>] [--save-baseline <file>] [--compare <file>] [--threshold <percent>] [--replay <file or directory>]...\n", argv[0]);
+            return 1;
+        }
+    }
+    
+    // read it up front, so a bad path doesn't waste a whole run
+    vector<BenchmarkResult> baseline;
+    if (!compareFilename.empty() && !loadBaseline(compareFilename, &baseline)) {
+        return 1;
+    }
+    
+    setUpKeys();
+    
+    if (!replays.empty()) {
+        // the replays run in the recordings' directories, so the baseline goes where it was asked for
+        filesystem::path workingDirectory = filesystem::current_path();
+        
+        if (!runReplays(&replays)) {
+            return 1;
+        }
+        
+        filesystem::current_path(workingDirectory);
+    } else {
+        if (!runMicrobenchmarks()) {
+            return 1;
+        }
+    }
+    
+    if (!baselineFilename.empty() && !writeFileAtomically(baselineFilename, output)) {
+        return 1;
+    }
+    
+    if (!compareFilename.empty() && !compareWithBaseline(&baseline)) {
+        return 1;
+    }
+    
+    return 0;
+}
+
+bool runMicrobenchmarks() {
+    level = new Level();
+    
+    print("{\n  \"benchmarks\": [");
+    
+    runBenchmark("getLineRectangleCollision/hit", benchLineRectHit, 1);
+    runBenchmark("getLineRectangleCollision/miss", benchLineRectMiss, 1);
+    runBenchmark("checkLineRectCollision/hit", benchCheckLineRectHit, 1);
+    runBenchmark("checkLineRectCollision/miss", benchCheckLineRectMiss, 1);
+    
+    for (int i = 0; i < NUMBER_OF_LEVEL_SIZES; i++) {
+        int size = LEVEL_SIZES[i];
+        if (!buildLevel(level, size)) {
+            return false;
+        }
+        placePlayer();
+        
+        runBenchmark("GrappleSeeker::seek/" + to_string(size), benchSeek, size);
+        
+        buildRope(0);
+        runBenchmark("Rope::collideCorners/" + to_string(size), benchCollideCorners, size);
+        
+        runBenchmark("Player::update/" + to_string(size), benchPlayerUpdate, size);
+    }
+    
+    // the rope benchmarks all hang over the same mid-sized level; the pivots are what changes
+    if (!buildLevel(level, 1000)) {
+        return false;
+    }
+    placePlayer();
+    
+    for (int i = 0; i < NUMBER_OF_PIVOT_COUNTS; i++) {
+        buildRope(PIVOT_COUNTS[i]);
+        runBenchmark("Rope::update/pivots:" + to_string(PIVOT_COUNTS[i]), benchRopeUpdate, 1000);
+    }
+    
+    print("\n  ]\n}\n");
+    
+    delete seeker;
+    delete rope;
+    delete player;
+    delete level;
+    
+    return true;
+}
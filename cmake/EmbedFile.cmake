@@ -0,0 +1,14 @@
+# writes OUTPUT, a C++ source defining NAME (the bytes of INPUT) and NAME_SIZE
+# usage: cmake -DINPUT=file -DOUTPUT=file.cpp -DNAME=SYMBOL -P EmbedFile.cmake
+
+file(READ ${INPUT} HEX_CONTENTS HEX)
+
+# 0x.. for every byte, 32 to a line
+string(REGEX REPLACE "([0-9a-f][0-9a-f])" "0x\\1," BYTES "${HEX_CONTENTS}")
+string(REGEX REPLACE "((0x[0-9a-f][0-9a-f],){32})" "\\1\n    " BYTES "${BYTES}")
+
+file(WRITE ${OUTPUT}
+    "// generated from ${INPUT} by EmbedFile.cmake, don't edit\n"
+    "#include <stddef.h>\n\n"
+    "extern const unsigned char ${NAME}[] = {\n    ${BYTES}\n};\n"
+    "extern const size_t ${NAME}_SIZE = sizeof(${NAME});\n")
@@ -0,0 +1,150 @@
+#include <cstdlib>
+#include <new>
+#include <stdio.h>
+
+#if defined __APPLE__ || defined __linux__
+#include <execinfo.h>
+#include <unistd.h>
+#endif
+
+#include "allocations.hpp"
+#include "stats.hpp"
+using namespace std;
+
+// zero initialised, so operator new can use it on a thread before anything else has run there
+thread_local ThreadAllocations threadAllocations = {};
+
+int hotAllocationPolicy = ALLOW_HOT_ALLOCATIONS;
+
+// hot paths that have been logged; after MAX_HOT_ALLOCATION_REPORTS the rest are only counted
+SDL_atomic_t hotAllocationReports;
+
+#ifdef UMIHARA_TRACK_ALLOCATIONS
+
+void reportHotAllocation(size_t size) {
+    ThreadAllocations *thread = &threadAllocations;
+    
+    // the rest of this path just gets counted, and backtrace() can allocate the first time it runs
+    if (thread->hotAllocations > 1 || thread->reporting) {
+        return;
+    }
+    
+    int reports = SDL_AtomicAdd(&hotAllocationReports, 1);
+    if (reports >= MAX_HOT_ALLOCATION_REPORTS && hotAllocationPolicy != ABORT_ON_HOT_ALLOCATIONS) {
+        if (reports == MAX_HOT_ALLOCATION_REPORTS) {
+            printf("not logging any more hot path allocations\n");
+        }
+        return;
+    }
+    
+    thread->reporting = true;
+    
+    printf("allocated %zu bytes inside %s:\n", size, thread->hotPath);
+    fflush(stdout);
+
+#if defined __APPLE__ || defined __linux__
+    void *frames[MAX_BACKTRACE_DEPTH];
+    int depth = backtrace(frames, MAX_BACKTRACE_DEPTH);
+    backtrace_symbols_fd(frames, depth, STDOUT_FILENO);
+#endif
+    
+    thread->reporting = false;
+    
+    if (hotAllocationPolicy == ABORT_ON_HOT_ALLOCATIONS) {
+        abort();
+    }
+}
+
+void *operator new(size_t size) {
+    ThreadAllocations *thread = &threadAllocations;
+    thread->allocations++;
+    thread->bytes += size;
+    
+    COUNT_STAT(ALLOCATIONS, 1);
+    COUNT_STAT(ALLOCATED_BYTES, static_cast<int>(size));
+    
+    if (thread->hotPath && hotAllocationPolicy != ALLOW_HOT_ALLOCATIONS) {
+        thread->hotAllocations++;
+        thread->hotBytes += size;
+        reportHotAllocation(size);
+    }
+    
+    void *p = malloc(size ? size : 1);
+    if (!p) {
+        throw bad_alloc();
+    }
+    
+    return p;
+}
+
+void *operator new[](size_t size) {
+    return operator new(size);
+}
+
+void operator delete(void *p) noexcept {
+    free(p);
+}
+
+void operator delete[](void *p) noexcept {
+    free(p);
+}
+
+void operator delete(void *p, size_t) noexcept {
+    free(p);
+}
+
+void operator delete[](void *p, size_t) noexcept {
+    free(p);
+}
+
+#endif
+
+bool isTrackingAllocations() {
+#ifdef UMIHARA_TRACK_ALLOCATIONS
+    return true;
+#else
+    return false;
+#endif
+}
+
+bool setHotAllocationPolicy(int policy) {
+#ifdef UMIHARA_TRACK_ALLOCATIONS
+    hotAllocationPolicy = policy;
+    return true;
+#else
+    if (policy != ALLOW_HOT_ALLOCATIONS) {
+        printf("Couldn't check hot path allocations. Error: built without UMIHARA_TRACK_ALLOCATIONS\n");
+        return false;
+    }
+    
+    return true;
+#endif
+}
+
+void beginHotPath(const char *name) {
+    threadAllocations.hotPath = name;
+    threadAllocations.hotAllocations = 0;
+    threadAllocations.hotBytes = 0;
+}
+
+const char *suspendHotPath() {
+    const char *name = threadAllocations.hotPath;
+    threadAllocations.hotPath = NULL;
+    
+    return name;
+}
+
+void resumeHotPath(const char *name) {
+    threadAllocations.hotPath = name;
+}
+
+void endHotPath() {
+    ThreadAllocations *thread = &threadAllocations;
+    
+    const char *name = thread->hotPath;
+    thread->hotPath = NULL;
+    
+    if (name && thread->hotAllocations > 1 && SDL_AtomicGet(&hotAllocationReports) <= MAX_HOT_ALLOCATION_REPORTS) {
+        printf("%llu allocations, %llu bytes in all, inside %s\n", static_cast<unsigned long long>(thread->hotAllocations), static_cast<unsigned long long>(thread->hotBytes), name);
+    }
+}
@@ -0,0 +1,63 @@
+#ifndef allocations_hpp
+#define allocations_hpp
+
+#if defined __APPLE__ || defined __linux__
+#include <SDL2/SDL.h>
+#endif
+
+#ifdef _WIN64
+#include <SDL.h>
+#endif
+
+// built with UMIHARA_TRACK_ALLOCATIONS (cmake -DUMIHARA_TRACK_ALLOCATIONS=ON, and always for umihara_bench),
+// allocations.cpp replaces the global operator new and delete to count every allocation: per thread,
+// per frame through the ALLOCATIONS and ALLOCATED_BYTES stats, and per profiling zone. otherwise the
+// standard allocator is left alone, the counts stay at zero and hot paths aren't checked
+
+enum HotAllocationPolicy {
+    ALLOW_HOT_ALLOCATIONS,
+    LOG_HOT_ALLOCATIONS,        // the first allocation in each hot path with a backtrace, then a total
+    ABORT_ON_HOT_ALLOCATIONS    // the same backtrace, then abort()
+};
+
+const int MAX_BACKTRACE_DEPTH = 32;
+const int MAX_HOT_ALLOCATION_REPORTS = 20;
+
+struct ThreadAllocations {
+    // since the thread started
+    Uint64 allocations;
+    Uint64 bytes;
+    
+    // the hot path the thread is in, or NULL, and what it has allocated there
+    const char *hotPath;
+    Uint64 hotAllocations;
+    Uint64 hotBytes;
+    
+    bool reporting;
+};
+
+extern thread_local ThreadAllocations threadAllocations;
+
+inline Uint64 getThreadAllocations() {
+    return threadAllocations.allocations;
+}
+
+inline Uint64 getThreadAllocatedBytes() {
+    return threadAllocations.bytes;
+}
+
+bool isTrackingAllocations();
+
+// set before starting any threads
+bool setHotAllocationPolicy(int policy);
+
+// allocations on this thread between these two are reported as the policy says. name is a string literal
+void beginHotPath(const char *name);
+void endHotPath();
+
+// for work inside a hot path that has to allocate, like streaming in a level's chunks. nothing
+// between the two is checked; resumeHotPath takes what suspendHotPath returned
+const char *suspendHotPath();
+void resumeHotPath(const char *name);
+
+#endif
@@ -0,0 +1,132 @@
+#include "canvas.hpp"
+#include "stats.hpp"
+#include "memory.hpp"
+
+EditorCanvas::EditorCanvas() {
+    _texture = NULL;
+    _width = MAP_WIDTH * PLATFORM_WIDTH;
+    _height = MAP_HEIGHT * PLATFORM_HEIGHT;
+    
+    _valid = false;
+    _cameraX = 0;
+    _cameraY = 0;
+    _revision = 0;
+}
+
+EditorCanvas::~EditorCanvas() {
+    destroy();
+}
+
+void EditorCanvas::setSize(int w, int h) {
+    _width = w;
+    _height = h;
+    
+    destroy();
+}
+
+void EditorCanvas::invalidate() {
+    _valid = false;
+}
+
+void EditorCanvas::destroy() {
+    if (_texture) {
+        SDL_DestroyTexture(_texture);
+        _texture = NULL;
+    }
+    
+    _valid = false;
+}
+
+void EditorCanvas::reportMemory(MemoryReport *report) {
+    if (_texture) {
+        size_t size = getTextureBytes(_texture);
+        report->add(SDL_TEXTURES, size, size);
+    }
+}
+
+bool EditorCanvas::createTexture(SDL_Renderer *renderer) {
+    _texture = SDL_CreateTexture(renderer, SDL_PIXELFORMAT_RGBA8888, SDL_TEXTUREACCESS_TARGET, _width, _height);
+    
+    if (!_texture) {
+        printf("Couldn't create editor canvas, drawing the editor directly. Error: %s\n", SDL_GetError());
+        return false;
+    }
+    
+    return true;
+}
+
+void EditorCanvas::draw(SDL_Renderer *renderer, Level *level, double cameraX, double cameraY) {
+    SDL_Rect view = { static_cast<int>(cameraX), static_cast<int>(cameraY), _width, _height };
+    
+    if (!_texture && !createTexture(renderer)) {
+        drawContents(renderer, level, &view, view.x, view.y);
+        return;
+    }
+    
+    SDL_SetRenderTarget(renderer, _texture);
+    
+    SDL_Rect dirtyAreas[EDIT_LOG_SIZE];
+    int numberOfDirtyAreas = 0;
+    
+    if (!_valid || view.x != _cameraX || view.y != _cameraY || !level->getEditsSince(_revision, dirtyAreas, &numberOfDirtyAreas)) {
+        _cameraX = view.x;
+        _cameraY = view.y;
+        
+        repaint(renderer, level, &view);
+    } else {
+        for (int i = 0; i < numberOfDirtyAreas; i++) {
+            SDL_Rect visibleArea;
+            if (SDL_IntersectRect(dirtyAreas + i, &view, &visibleArea)) {
+                repaint(renderer, level, &visibleArea);
+            }
+        }
+    }
+    
+    _valid = true;
+    _revision = level->getRevision();
+    
+    SDL_SetRenderTarget(renderer, NULL);
+    
+    SDL_Rect destination = { 0, 0, _width, _height };
+    SDL_RenderCopy(renderer, _texture, NULL, &destination);
+    COUNT_STAT(DRAW_CALLS, 1);
+}
+
+void EditorCanvas::repaint(SDL_Renderer *renderer, Level *level, SDL_Rect *area) {
+    SDL_Rect clip = { area->x - _cameraX, area->y - _cameraY, area->w, area->h };
+    SDL_RenderSetClipRect(renderer, &clip);
+    
+    SDL_SetRenderDrawColor(renderer, 0x00, 0x00, 0x00, 0xFF);
+    SDL_RenderFillRect(renderer, &clip);
+    COUNT_STAT(DRAW_CALLS, 1);
+    
+    drawContents(renderer, level, area, _cameraX, _cameraY);
+    
+    SDL_RenderSetClipRect(renderer, NULL);
+}
+
+void EditorCanvas::drawContents(SDL_Renderer *renderer, Level *level, SDL_Rect *area, int cameraX, int cameraY) {
+    // every platform sits on one tile, so the tile index finds the ones under the area without
+    // going through the whole level. rounded down, since the area can start left of or above 0
+    int firstX = area->x / PLATFORM_WIDTH - (area->x % PLATFORM_WIDTH < 0 ? 1 : 0);
+    int firstY = area->y / PLATFORM_HEIGHT - (area->y % PLATFORM_HEIGHT < 0 ? 1 : 0);
+    
+    for (int y = firstY; y * PLATFORM_HEIGHT < area->y + area->h; y++) {
+        for (int x = firstX; x * PLATFORM_WIDTH < area->x + area->w; x++) {
+            int i = level->platformExists(x * PLATFORM_WIDTH, y * PLATFORM_HEIGHT);
+            if (i >= 0) {
+                level->getPlatform(i)->draw(renderer, cameraX, cameraY);
+            }
+        }
+    }
+    
+    SDL_SetRenderDrawColor(renderer, 0xFF, 0xFF, 0x00, 0xFF);
+    SDL_Rect endPosRect = { level->getEndX() - cameraX, level->getEndY() - cameraY, PLATFORM_WIDTH, PLATFORM_HEIGHT };
+    SDL_RenderFillRect(renderer, &endPosRect);
+    COUNT_STAT(DRAW_CALLS, 1);
+    
+    SDL_SetRenderDrawColor(renderer, 0xFF, 0x00, 0x00, 0xFF);
+    SDL_Rect startPosRect = { level->getStartX() - cameraX, level->getStartY() - cameraY, PLATFORM_WIDTH, PLATFORM_HEIGHT };
+    SDL_RenderFillRect(renderer, &startPosRect);
+    COUNT_STAT(DRAW_CALLS, 1);
+}
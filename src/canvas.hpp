@@ -0,0 +1,46 @@
+#ifndef canvas_hpp
+#define canvas_hpp
+
+#if defined __APPLE__ || defined __linux__
+#include <SDL2/SDL.h>
+#endif
+
+#ifdef _WIN64
+#include <SDL.h>
+#endif
+
+#include "level.hpp"
+
+// persistent texture holding the editor's view of the level. only the areas the level's edit log
+// reports as changed get repainted; everything is redrawn when the camera scrolls.
+class EditorCanvas {
+public:
+    EditorCanvas();
+    ~EditorCanvas();
+    
+    void setSize(int w, int h);
+    
+    void invalidate();
+    void destroy();
+    
+    void draw(SDL_Renderer *renderer, Level *level, double cameraX, double cameraY);
+    
+    void reportMemory(MemoryReport *report);
+    
+private:
+    bool createTexture(SDL_Renderer *renderer);
+    
+    void repaint(SDL_Renderer *renderer, Level *level, SDL_Rect *area);
+    void drawContents(SDL_Renderer *renderer, Level *level, SDL_Rect *area, int cameraX, int cameraY);
+    
+    SDL_Texture *_texture;
+    int _width;
+    int _height;
+    
+    bool _valid;
+    int _cameraX;
+    int _cameraY;
+    int _revision;
+};
+
+#endif
@@ -1,7 +1,13 @@
+#include <string.h>
+
 #include "controls.hpp"
 
 void KeyboardLayout::updateKey(const Uint8 *keys, int key, int *keyState) {
-    if (keys[key]) {
+    updateButton(key >= 0 && keys[key], keyState);
+}
+
+void KeyboardLayout::updateButton(bool down, int *keyState) {
+    if (down) {
         if (*keyState == NONE) {
             *keyState = PRESSED;
         } else {
@@ -35,6 +41,48 @@ void KeyboardLayout::update(const Uint8 *keys) {
     updateKey(keys, _playToggle, &_playToggleState);
 }
 
+void KeyboardLayout::updateButtons(Uint32 buttons) {
+    updateButton(buttons & LEFT_BUTTON, &_leftState);
+    updateButton(buttons & RIGHT_BUTTON, &_rightState);
+    updateButton(buttons & UP_BUTTON, &_upState);
+    updateButton(buttons & DOWN_BUTTON, &_downState);
+    
+    updateButton(buttons & CONFIRM_BUTTON, &_confirmState);
+    updateButton(buttons & BACK_BUTTON, &_backState);
+    updateButton(buttons & PAUSE_BUTTON, &_pauseState);
+    
+    updateButton(buttons & JUMP_BUTTON, &_jumpState);
+    updateButton(buttons & GRAPPLE_BUTTON, &_grappleState);
+    updateButton(buttons & AIR_BLAST_BUTTON, &_airBlastState);
+    
+    updateButton(buttons & RESET_BUTTON, &_resetState);
+    
+    updateButton(buttons & NEXT_EDITOR_MODE_BUTTON, &_nextEditorModeState);
+    updateButton(buttons & PREVIOUS_EDITOR_MODE_BUTTON, &_previousEditorModeState);
+    updateButton(buttons & NEXT_PLATFORM_TYPE_BUTTON, &_nextPlatformTypeState);
+    updateButton(buttons & PREVIOUS_PLATFORM_TYPE_BUTTON, &_previousPlatformTypeState);
+    updateButton(buttons & PLAY_TOGGLE_BUTTON, &_playToggleState);
+}
+
+Uint32 KeyboardLayout::getHeldButtons() {
+    int states[NUMBER_OF_INPUT_BUTTONS] = {
+        _leftState, _rightState, _upState, _downState,
+        _confirmState, _backState, _pauseState,
+        _jumpState, _grappleState, _airBlastState,
+        _resetState,
+        _nextEditorModeState, _previousEditorModeState, _nextPlatformTypeState, _previousPlatformTypeState, _playToggleState
+    };
+    
+    Uint32 buttons = 0;
+    for (int i = 0; i < NUMBER_OF_INPUT_BUTTONS; i++) {
+        if (states[i] != NONE) {
+            buttons |= 1 << i;
+        }
+    }
+    
+    return buttons;
+}
+
 int KeyboardLayout::getLeftState() {
     return _leftState;
 }
@@ -255,3 +303,41 @@ void MouseState::update() {
         _middleClickState = HELD;
     }
 }
+
+InputQueue::InputQueue() {
+    _mutex = SDL_CreateMutex();
+    
+    memset(_keys, 0, sizeof(_keys));
+    _numberOfLetters = 0;
+}
+
+InputQueue::~InputQueue() {
+    SDL_DestroyMutex(_mutex);
+}
+
+void InputQueue::push(const Uint8 *keys, char letters[], int numLetters) {
+    SDL_LockMutex(_mutex);
+    
+    memcpy(_keys, keys, sizeof(_keys));
+    for (int i = 0; i < numLetters && _numberOfLetters < MAX_QUEUED_LETTERS; i++) {
+        _letters[_numberOfLetters] = letters[i];
+        _numberOfLetters++;
+    }
+    
+    SDL_UnlockMutex(_mutex);
+}
+
+int InputQueue::take(Uint8 *keys, char letters[]) {
+    SDL_LockMutex(_mutex);
+    
+    memcpy(keys, _keys, sizeof(_keys));
+    int numLetters = _numberOfLetters;
+    for (int i = 0; i < numLetters; i++) {
+        letters[i] = _letters[i];
+    }
+    _numberOfLetters = 0;
+    
+    SDL_UnlockMutex(_mutex);
+    
+    return numLetters;
+}
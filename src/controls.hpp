@@ -11,17 +11,49 @@
 
 #include <stdio.h>
 
+const int MAX_QUEUED_LETTERS = 50;
+
 enum InputState {
     NONE,
     PRESSED,
     HELD
 };
 
+// one bit per KeyboardLayout key, for recording input and playing it back
+enum InputButton {
+    LEFT_BUTTON = 1 << 0,
+    RIGHT_BUTTON = 1 << 1,
+    UP_BUTTON = 1 << 2,
+    DOWN_BUTTON = 1 << 3,
+    CONFIRM_BUTTON = 1 << 4,
+    BACK_BUTTON = 1 << 5,
+    PAUSE_BUTTON = 1 << 6,
+    JUMP_BUTTON = 1 << 7,
+    GRAPPLE_BUTTON = 1 << 8,
+    AIR_BLAST_BUTTON = 1 << 9,
+    RESET_BUTTON = 1 << 10,
+    NEXT_EDITOR_MODE_BUTTON = 1 << 11,
+    PREVIOUS_EDITOR_MODE_BUTTON = 1 << 12,
+    NEXT_PLATFORM_TYPE_BUTTON = 1 << 13,
+    PREVIOUS_PLATFORM_TYPE_BUTTON = 1 << 14,
+    PLAY_TOGGLE_BUTTON = 1 << 15
+};
+
+constexpr int NUMBER_OF_INPUT_BUTTONS = 16;
+
+// how replay files write each button, lowest bit first
+const char INPUT_BUTTON_LETTERS[NUMBER_OF_INPUT_BUTTONS + 1] = "LRUDCBPJGAXEQNMS";
+
 class KeyboardLayout {
 public:
     void updateKey(const Uint8 *keys, int key, int *keyState);
+    void updateButton(bool down, int *keyState);
     void update(const Uint8 *keys);
     
+    // the same as update, from InputButton bits rather than the keyboard
+    void updateButtons(Uint32 buttons);
+    Uint32 getHeldButtons();
+    
     int getLeftState();
     int getRightState();
     int getUpState();
@@ -148,4 +180,23 @@ private:
     int _scrollY;
 };
 
+// hands keyboard state and typed letters from the event loop to the simulation thread
+class InputQueue {
+public:
+    InputQueue();
+    ~InputQueue();
+    
+    void push(const Uint8 *keys, char letters[], int numLetters);
+    
+    // copies the latest keyboard state and drains the typed letters, returns how many were taken
+    int take(Uint8 *keys, char letters[]);
+
+private:
+    SDL_mutex *_mutex;
+    
+    Uint8 _keys[SDL_NUM_SCANCODES];
+    char _letters[MAX_QUEUED_LETTERS];
+    int _numberOfLetters;
+};
+
 #endif
@@ -0,0 +1,175 @@
+#include <stdio.h>
+#include <filesystem>
+
+#if defined __APPLE__ || defined __linux__
+#include <unistd.h>
+#endif
+
+#ifdef _WIN64
+#include <io.h>
+#endif
+
+#include "filewriter.hpp"
+
+bool writeFileAtomically(string path, const string &data) {
+    string temporaryPath = path + ".tmp";
+    
+    FILE *file = fopen(temporaryPath.c_str(), "wb");
+    if (!file) {
+        printf("Couldn't open %s for writing\n", temporaryPath.c_str());
+        return false;
+    }
+    
+    bool written = fwrite(data.data(), 1, data.size(), file) == data.size() && fflush(file) == 0;
+    
+    // make sure the new contents are on disk before the rename can make them visible
+#if defined __APPLE__ || defined __linux__
+    written = written && fsync(fileno(file)) == 0;
+#endif
+    
+#ifdef _WIN64
+    written = written && _commit(_fileno(file)) == 0;
+#endif
+    
+    written = fclose(file) == 0 && written;
+    
+    if (!written) {
+        printf("Couldn't write %s\n", temporaryPath.c_str());
+        remove(temporaryPath.c_str());
+        return false;
+    }
+    
+    error_code error;
+    filesystem::rename(temporaryPath, path, error);
+    if (error) {
+        printf("Couldn't replace %s. Error: %s\n", path.c_str(), error.message().c_str());
+        remove(temporaryPath.c_str());
+        return false;
+    }
+    
+    return true;
+}
+
+FileWriter::FileWriter() {
+    _thread = NULL;
+    _mutex = NULL;
+    _queueChanged = NULL;
+    _queueEmptied = NULL;
+    
+    _writing = false;
+    _stopping = false;
+}
+
+FileWriter::~FileWriter() {
+    stop();
+}
+
+bool FileWriter::start() {
+    _mutex = SDL_CreateMutex();
+    _queueChanged = SDL_CreateCond();
+    _queueEmptied = SDL_CreateCond();
+    if (!_mutex || !_queueChanged || !_queueEmptied) {
+        printf("Couldn't create file writer locks. Error: %s\n", SDL_GetError());
+        return false;
+    }
+    
+    _stopping = false;
+    
+    _thread = SDL_CreateThread(writeFiles, "file writer", this);
+    if (!_thread) {
+        printf("Couldn't create file writer thread. Error: %s\n", SDL_GetError());
+        return false;
+    }
+    
+    return true;
+}
+
+void FileWriter::stop() {
+    if (_thread) {
+        SDL_LockMutex(_mutex);
+        _stopping = true;
+        SDL_CondSignal(_queueChanged);
+        SDL_UnlockMutex(_mutex);
+        
+        SDL_WaitThread(_thread, NULL);
+        _thread = NULL;
+    }
+    
+    SDL_DestroyCond(_queueEmptied);
+    SDL_DestroyCond(_queueChanged);
+    SDL_DestroyMutex(_mutex);
+    _queueEmptied = NULL;
+    _queueChanged = NULL;
+    _mutex = NULL;
+}
+
+void FileWriter::write(string path, string data) {
+    // no thread to hand it to (tools, or start() failed), so just write it now
+    if (!_thread) {
+        writeFileAtomically(path, data);
+        return;
+    }
+    
+    SDL_LockMutex(_mutex);
+    
+    map<string, string>::iterator pending = _pending.find(path);
+    if (pending != _pending.end()) {
+        pending->second.swap(data);
+    } else {
+        _pending[path].swap(data);
+        _queue.push_back(path);
+        SDL_CondSignal(_queueChanged);
+    }
+    
+    SDL_UnlockMutex(_mutex);
+}
+
+void FileWriter::flush() {
+    if (!_thread) {
+        return;
+    }
+    
+    SDL_LockMutex(_mutex);
+    while (!_queue.empty() || _writing) {
+        SDL_CondWait(_queueEmptied, _mutex);
+    }
+    SDL_UnlockMutex(_mutex);
+}
+
+int FileWriter::writeFiles(void *data) {
+    FileWriter *writer = static_cast<FileWriter *>(data);
+    
+    SDL_LockMutex(writer->_mutex);
+    while (true) {
+        while (writer->_queue.empty() && !writer->_stopping) {
+            SDL_CondWait(writer->_queueChanged, writer->_mutex);
+        }
+        
+        // only stop once everything queued has been written
+        if (writer->_queue.empty()) {
+            break;
+        }
+        
+        string path = writer->_queue.front();
+        writer->_queue.pop_front();
+        
+        string contents;
+        contents.swap(writer->_pending[path]);
+        writer->_pending.erase(path);
+        
+        writer->_writing = true;
+        SDL_UnlockMutex(writer->_mutex);
+        
+        writeFileAtomically(path, contents);
+        
+        SDL_LockMutex(writer->_mutex);
+        writer->_writing = false;
+        
+        if (writer->_queue.empty()) {
+            SDL_CondBroadcast(writer->_queueEmptied);
+        }
+    }
+    SDL_UnlockMutex(writer->_mutex);
+    
+    return 0;
+}
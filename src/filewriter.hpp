@@ -0,0 +1,53 @@
+#ifndef filewriter_hpp
+#define filewriter_hpp
+
+#if defined __APPLE__ || defined __linux__
+#include <SDL2/SDL.h>
+#endif
+
+#ifdef _WIN64
+#include <SDL.h>
+#endif
+
+#include <deque>
+#include <map>
+#include <string>
+using namespace std;
+
+// writes data to a temporary file next to path, syncs it to disk and renames it over path,
+// so path always holds either the old contents or the new ones
+bool writeFileAtomically(string path, const string &data);
+
+// writes files on a background thread. a file queued again before the writer gets to it is only
+// written once, with the newest contents
+class FileWriter {
+public:
+    FileWriter();
+    ~FileWriter();
+    
+    bool start();
+    
+    // writes everything still queued before returning
+    void stop();
+    
+    void write(string path, string data);
+    
+    // blocks until everything queued so far is on disk
+    void flush();
+    
+private:
+    static int writeFiles(void *data);
+    
+    SDL_Thread *_thread;
+    SDL_mutex *_mutex;
+    SDL_cond *_queueChanged;
+    SDL_cond *_queueEmptied;
+    
+    // guarded by _mutex
+    deque<string> _queue;
+    map<string, string> _pending;
+    bool _writing;
+    bool _stopping;
+};
+
+#endif
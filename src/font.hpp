@@ -0,0 +1,10 @@
+#ifndef font_hpp
+#define font_hpp
+
+#include <stddef.h>
+
+// font.ttf, compiled into the binary by cmake/EmbedFile.cmake
+extern const unsigned char FONT_DATA[];
+extern const size_t FONT_DATA_SIZE;
+
+#endif
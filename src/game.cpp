@@ -5,6 +5,15 @@
 #include "player.hpp"
 #include "level.hpp"
 #include "text.hpp"
+#include "canvas.hpp"
+#include "levelindex.hpp"
+#include "filewriter.hpp"
+#include "scores.hpp"
+#include "levelpack.hpp"
+#include "profiler.hpp"
+#include "stats.hpp"
+#include "allocations.hpp"
+#include "memory.hpp"
 using namespace std;
 
 const string VERSION = "indev 9 (on hold)";
@@ -18,15 +27,24 @@ bool selectingLevel = false;
 
 Player player;
 Level level;
+FileWriter fileWriter;
+ScoreStore scores;
+EditorCanvas editorCanvas;
 string levelFilename;
 
+// packed levels are played straight from the pack's mapping
+LevelPack levelPack;
+bool levelFromPack = false;
+
 // menu text
 TextBox title;
 TextSelection titleOptions;
 TextBox levelNameIndicator;
 TextInput newLevelName;
 TextSelection levelSelector;
-vector<filesystem::path> availableLevels;
+vector<LevelIndexEntry> availableLevels;
+LevelIndex levelIndex;
+int shownLevelIndexGeneration = -1;
 TextBox versionIndicator;
 
 // level end text
@@ -57,6 +75,9 @@ int maxTimerWidth;
 int editorCursorX = MAP_WIDTH / 2;
 int editorCursorY = MAP_HEIGHT / 2;
 
+// whether the player has had a tick since the level was (re)started
+bool playerSettled = false;
+
 double cameraX;
 double cameraY;
 const int CAMERA_WIDTH = MAP_WIDTH * PLATFORM_WIDTH - 1;
@@ -69,11 +90,36 @@ const int RETURN_FRAMES = 15;
 double returnVelocityX;
 double returnVelocityY;
 
+// the text widgets are shared between the simulation and render threads
+SDL_mutex *uiMutex = NULL;
+
+bool menuTextReady = false;
+bool levelEndTextReady = false;
+bool pauseTextReady = false;
+bool editorTextReady = false;
+bool gameTextReady = false;
+
+// see gameRecordLevelMemory
+MemoryReport *levelMemoryReport = NULL;
+
+bool updateGameState(KeyboardLayout *keys, char pressedLetters[], int numPressedLetters);
 void updateLevelEditor(KeyboardLayout *keys);
 bool updateMenu(KeyboardLayout *keys, char pressedLetters[], int numPressedLetters);
 void resetLevel(bool animate);
+void startLevel();
 
 void updateAvailableLevels();
+string getLevelOptionText(LevelIndexEntry *entry);
+void loadFastestTime();
+bool isLevelEditable();
+
+// each screen's text is set up the first time the screen is updated or drawn, not all at startup
+void initScreenText(int gameState);
+void initMenuText();
+void initLevelEndText();
+void initPauseText();
+void initEditorText();
+void initGameText();
 
 bool gameInit() {
     filesystem::path levels("levels");
@@ -82,7 +128,127 @@ bool gameInit() {
         filesystem::create_directory(levels);
     }
     
-    // menu text
+    uiMutex = SDL_CreateMutex();
+    if (!uiMutex) {
+        printf("Couldn't create UI mutex. Error: %s\n", SDL_GetError());
+        return false;
+    }
+    
+    if (!levelIndex.start()) {
+        return false;
+    }
+    
+    if (!fileWriter.start()) {
+        return false;
+    }
+    
+    // the fastest times are only a cache, so the game plays on without them
+    scores.open(SCORE_LOG_FILENAME);
+    
+    return true;
+}
+
+bool gameInitHeadless() {
+    uiMutex = SDL_CreateMutex();
+    if (!uiMutex) {
+        printf("Couldn't create UI mutex. Error: %s\n", SDL_GetError());
+        return false;
+    }
+    
+    return true;
+}
+
+bool gameStartLevel(string name) {
+    if (!level.loadLevel(name)) {
+        printf("Couldn't start level %s\n", name.c_str());
+        return false;
+    }
+    
+    levelFilename = name;
+    levelFromPack = false;
+    
+    startLevel();
+    return true;
+}
+
+bool gameIsPlayingLevelFile() {
+    if (levelFromPack) {
+        return false;
+    }
+    
+    return currentGameState == GAME || currentGameState == PAUSE || currentGameState == LEVEL_END || currentGameState == LEVEL_RESET;
+}
+
+string gameGetLevelName() {
+    return levelFilename;
+}
+
+void gameGetFrameContext(FrameContext *context) {
+    context->gameState = currentGameState;
+    context->levelName = levelFilename;
+    
+    context->playerX = player.getX();
+    context->playerY = player.getY();
+    context->velocityX = player.getVelocityX();
+    context->velocityY = player.getVelocityY();
+    
+    context->ropePivots = player.getNumberOfPivots();
+    context->platforms = level.getNumberOfPlatforms();
+}
+
+void gameCleanUp() {
+    player.destroyGrappleSeeker();
+    player.destroyRope();
+    
+    editorCanvas.destroy();
+    destroyRetiredTextTextures();
+    closeFonts();
+    fileWriter.stop();
+    scores.close();
+    levelIndex.stop();
+    
+    SDL_DestroyMutex(uiMutex);
+    uiMutex = NULL;
+}
+
+void gameRecordLevelMemory(MemoryReport *report) {
+    levelMemoryReport = report;
+}
+
+void gameReportMemory(MemoryReport *report) {
+    report->beginSection("level " + (levelFilename.empty() ? string("(none)") : levelFilename));
+    level.reportMemory(report);
+    
+    report->beginSection("player");
+    player.reportMemory(report);
+    
+    report->beginSection("text");
+    reportTextMemory(report);
+    
+    report->beginSection("editor");
+    editorCanvas.reportMemory(report);
+}
+
+void initScreenText(int gameState) {
+    if (gameState == MENU && !menuTextReady) {
+        initMenuText();
+        menuTextReady = true;
+    } else if (gameState == LEVEL_END && !levelEndTextReady) {
+        initLevelEndText();
+        levelEndTextReady = true;
+    } else if (gameState == PAUSE && !pauseTextReady) {
+        initPauseText();
+        pauseTextReady = true;
+    } else if (gameState == LEVEL_EDITOR && !editorTextReady) {
+        initEditorText();
+        editorTextReady = true;
+    } else if (gameState == GAME && !gameTextReady) {
+        initGameText();
+        gameTextReady = true;
+    }
+}
+
+void initMenuText() {
     title.setText("Grappling Hook Prototype");
     title.setColor(0xFF, 0xFF, 0xFF, 0xFF);
     title.setX(10);
@@ -123,8 +289,9 @@ bool gameInit() {
     levelSelector.setScrollable(true);
     levelSelector.setItemsToDisplay(3);
     levelSelector.setFontSize(24);
-    
-    // level end text
+}
+
+void initLevelEndText() {
     winIndicator.setText("Level End");
     winIndicator.setColor(0xFF, 0xFF, 0xFF, 0xFF);
     winIndicator.setX(250);
@@ -154,8 +321,9 @@ bool gameInit() {
     endOptions.addOption("EDIT", 0xFF, 0xFF, 0xFF, 0xFF);
     endOptions.addOption("RESET FASTEST", 0xFF, 0xFF, 0xFF, 0xFF);
     endOptions.addOption("MAIN MENU", 0xFF, 0xFF, 0xFF, 0xFF);
-    
-    // pause text
+}
+
+void initPauseText() {
     pauseIndicator.setText("IN-GAME MENU");
     pauseIndicator.setX(250);
     pauseIndicator.setY(100);
@@ -169,8 +337,9 @@ bool gameInit() {
     pauseOptions.addOption("RESUME", 0xFF, 0xFF, 0xFF, 0xFF);
     pauseOptions.addOption("RETRY", 0xFF, 0xFF, 0xFF, 0xFF);
     pauseOptions.addOption("MAIN MENU", 0xFF, 0xFF, 0xFF, 0xFF);
-    
-    // editor text
+}
+
+void initEditorText() {
     editorIndicator.setText("EDITOR");
     editorIndicator.setColor(0x00, 0xFF, 0x00, 0xFF);
     editorIndicator.setX(10);
@@ -186,8 +355,9 @@ bool gameInit() {
     platformType.setX(10);
     platformType.setY(79);
     platformType.initFont(24);
-    
-    // game text
+}
+
+void initGameText() {
     timer.setColor(0xFF, 0xFF, 0x00, 0xFF);
     timer.setX(5);
     timer.setY(2);
@@ -198,23 +368,45 @@ bool gameInit() {
     timerBackground.setWidth(100);
     timerBackground.setHeight(32);
     timerBackground.setColor(0x00, 0x00, 0x00, 0x77);
-    
-    return true;
 }
 
-void gameCleanUp() {
-    player.destroyGrappleSeeker();
-    player.destroyRope();
+void gameLockUi() {
+    SDL_LockMutex(uiMutex);
+}
+
+void gameUnlockUi() {
+    SDL_UnlockMutex(uiMutex);
 }
 
 bool gameUpdate(KeyboardLayout *keys, char pressedLetters[], int numPressedLetters) {
+    PROFILE_ZONE("gameUpdate");
+    
+    SDL_LockMutex(uiMutex);
+    initScreenText(currentGameState);
+    bool running = updateGameState(keys, pressedLetters, numPressedLetters);
+    SDL_UnlockMutex(uiMutex);
+    
+    return running;
+}
+
+void gameSnapshot(RenderSnapshot *snapshot) {
+    snapshot->setGameState(currentGameState);
+    snapshot->setLevelName(levelFilename);
+    snapshot->setCamera(cameraX, cameraY);
+    snapshot->setEditorCursor(editorCursorX, editorCursorY, currentLevelEditorMode);
+    
+    player.snapshot(snapshot->getPlayer(), snapshot->getGrapple());
+    snapshot->copyLevel(&level);
+}
+
+bool updateGameState(KeyboardLayout *keys, char pressedLetters[], int numPressedLetters) {
     if (keys->getPlayToggleState() == PRESSED) {
-        if (currentGameState == GAME) {
+        if (currentGameState == GAME && isLevelEditable()) {
             currentGameState = LEVEL_EDITOR;
         } else if (currentGameState == LEVEL_EDITOR) {
             level.correctLevel();
-            level.setFastestTime(-1);
-            level.saveLevel(levelFilename);
+            level.saveLevel(levelFilename, &fileWriter);
+            loadFastestTime();
             
             currentGameState = GAME;
             
@@ -255,7 +447,7 @@ bool gameUpdate(KeyboardLayout *keys, char pressedLetters[], int numPressedLette
             bool newFastest = false;
             if (secondsTaken < level.getFastestTime() || level.getFastestTime() < 0) {
                 level.setFastestTime(secondsTaken);
-                level.saveLevel(levelFilename);
+                scores.recordTime(level.getContentHash(), secondsTaken);
                 newFastest = true;
             }
             
@@ -274,7 +466,17 @@ bool gameUpdate(KeyboardLayout *keys, char pressedLetters[], int numPressedLette
             fastestIndicator.detectWidth();
         }
         
-        if (!player.update(keys, &level)) {
+        // the first tick on a level can still make things (stream in chunks, say); after that the
+        // player's tick is a hot path, checked for allocations with --hot-allocations
+        if (playerSettled) {
+            beginHotPath("Player::update");
+        }
+        bool alive = player.update(keys, &level);
+        endHotPath();
+        
+        playerSettled = true;
+        
+        if (!alive) {
             resetLevel(true);
             return true;
         }
@@ -296,7 +498,6 @@ bool gameUpdate(KeyboardLayout *keys, char pressedLetters[], int numPressedLette
         } else if (pauseSelection == 2) {
             pauseOptions.resetSelection();
             
-            level.saveLevel(levelFilename);
             currentGameState = MENU;
             level.resetLevel();
             
@@ -315,18 +516,17 @@ bool gameUpdate(KeyboardLayout *keys, char pressedLetters[], int numPressedLette
             resetLevel(false);
             currentGameState = GAME;
             endOptions.resetSelection();
-        } else if (endOption == 1) {
+        } else if (endOption == 1 && isLevelEditable()) {
             resetLevel(false);
             currentGameState = LEVEL_EDITOR;
             endOptions.resetSelection();
         } else if (endOption == 2) {
             level.setFastestTime(-1);
-            level.saveLevel(levelFilename);
+            scores.clearTime(level.getContentHash());
             fastestIndicator.setText("Fastest: no data");
             fastestIndicator.detectWidth();
             endOptions.resetSelection();
         } else if (endOption == 3) {
-            level.saveLevel(levelFilename);
             level.resetLevel();
             currentGameState = MENU;
             endOptions.resetSelection();
@@ -358,36 +558,57 @@ bool gameUpdate(KeyboardLayout *keys, char pressedLetters[], int numPressedLette
         } else if (cameraY + CAMERA_HEIGHT > level.getMaxY()) {
             cameraY = level.getMaxY() - CAMERA_HEIGHT;
         }
+        
+        // the camera follows the player, so this streams in around both
+        level.updateStreaming(cameraX, cameraY, CAMERA_WIDTH, CAMERA_HEIGHT);
     }
     
     return true;
 }
 
-void gameDraw(SDL_Renderer* renderer) {
-    if (currentGameState == GAME) {
-        level.draw(renderer, cameraX, cameraY);
-        player.draw(renderer, cameraX, cameraY);
+void gameDraw(SDL_Renderer *renderer, RenderSnapshot *snapshot) {
+    PROFILE_ZONE("gameDraw");
+    
+    SDL_LockMutex(uiMutex);
+    destroyRetiredTextTextures();
+    SDL_UnlockMutex(uiMutex);
+    
+    int gameState = snapshot->getGameState();
+    double snapshotCameraX = snapshot->getCameraX();
+    double snapshotCameraY = snapshot->getCameraY();
+    
+    if (gameState == GAME) {
+        snapshot->getLevel()->draw(renderer, snapshotCameraX, snapshotCameraY);
+        snapshot->drawPlayer(renderer, snapshotCameraX, snapshotCameraY);
+        
+        SDL_LockMutex(uiMutex);
+        initScreenText(gameState);
         timerBackground.setWidth(maxTimerWidth + 10);
         timerBackground.draw(renderer);
         timer.draw(renderer);
-    } else if (currentGameState == PAUSE) {
+        SDL_UnlockMutex(uiMutex);
+    } else if (gameState == PAUSE) {
+        SDL_LockMutex(uiMutex);
+        initScreenText(gameState);
         pauseIndicator.draw(renderer);
         pauseOptions.draw(renderer);
-    } else if (currentGameState == LEVEL_EDITOR) {
-        level.draw(renderer, cameraX, cameraY);
+        SDL_UnlockMutex(uiMutex);
+    } else if (gameState == LEVEL_EDITOR) {
+        // platforms and start/end markers, repainted only where the level changed
+        editorCanvas.draw(renderer, snapshot->getLevel(), snapshotCameraX, snapshotCameraY);
         
         int r, g, b, a;
-        if (currentLevelEditorMode == PLATFORM) {
+        if (snapshot->getEditorMode() == PLATFORM) {
             r = 0x00;
             g = 0xFF;
             b = 0x00;
             a = 0xFF;
-        } else if (currentLevelEditorMode == START_POINT) {
+        } else if (snapshot->getEditorMode() == START_POINT) {
             r = 0xFF;
             g = 0x00;
             b = 0x00;
             a = 0xFF;
-        } else if (currentLevelEditorMode == END_POINT) {
+        } else if (snapshot->getEditorMode() == END_POINT) {
             r = 0xFF;
             g = 0xFF;
             b = 0x00;
@@ -400,17 +621,19 @@ void gameDraw(SDL_Renderer* renderer) {
         }
         
         SDL_SetRenderDrawColor(renderer, r, g, b, a);
-        SDL_Rect cursorRect = { editorCursorX * PLATFORM_WIDTH - 1 - static_cast<int>(cameraX), editorCursorY * PLATFORM_WIDTH - 1 - static_cast<int>(cameraY), PLATFORM_WIDTH + 2, PLATFORM_HEIGHT + 2 };
+        SDL_Rect cursorRect = { snapshot->getEditorCursorX() * PLATFORM_WIDTH - 1 - static_cast<int>(snapshotCameraX), snapshot->getEditorCursorY() * PLATFORM_WIDTH - 1 - static_cast<int>(snapshotCameraY), PLATFORM_WIDTH + 2, PLATFORM_HEIGHT + 2 };
         SDL_RenderDrawRect(renderer, &cursorRect);
-        
-        SDL_SetRenderDrawColor(renderer, 0xFF, 0x00, 0x00, 0xFF);
-        SDL_Rect startPosRect = { level.getStartX() - static_cast<int>(cameraX), level.getStartY() - static_cast<int>(cameraY), PLATFORM_WIDTH, PLATFORM_HEIGHT };
-        SDL_RenderFillRect(renderer, &startPosRect);
+        COUNT_STAT(DRAW_CALLS, 1);
 
+        SDL_LockMutex(uiMutex);
+        initScreenText(gameState);
         editorIndicator.draw(renderer);
         editorMode.draw(renderer);
         platformType.draw(renderer);
-    } else if (currentGameState == MENU) {
+        SDL_UnlockMutex(uiMutex);
+    } else if (gameState == MENU) {
+        SDL_LockMutex(uiMutex);
+        initScreenText(gameState);
         title.draw(renderer);
         titleOptions.draw(renderer);
         versionIndicator.draw(renderer);
@@ -421,15 +644,19 @@ void gameDraw(SDL_Renderer* renderer) {
         } else if (selectingLevel) {
             levelSelector.draw(renderer);
         }
-    } else if (currentGameState == LEVEL_END) {
+        SDL_UnlockMutex(uiMutex);
+    } else if (gameState == LEVEL_END) {
+        SDL_LockMutex(uiMutex);
+        initScreenText(gameState);
         winIndicator.draw(renderer);
         levelName.draw(renderer);
         timeIndicator.draw(renderer);
         fastestIndicator.draw(renderer);
         endOptions.draw(renderer);
-    } else if (currentGameState == LEVEL_RESET) {
-        level.draw(renderer, cameraX, cameraY);
-        player.draw(renderer, cameraX, cameraY);
+        SDL_UnlockMutex(uiMutex);
+    } else if (gameState == LEVEL_RESET) {
+        snapshot->getLevel()->draw(renderer, snapshotCameraX, snapshotCameraY);
+        snapshot->drawPlayer(renderer, snapshotCameraX, snapshotCameraY);
     }
 }
 
@@ -562,18 +789,12 @@ bool updateMenu(KeyboardLayout *keys, char pressedLetters[], int numPressedLette
     if (creatingLevel) {
         if (keys->getConfirmState() == PRESSED) {
             if (newLevelName.getText() != "") {
-                bool levelExists = false;
-                updateAvailableLevels();
-                for (int i = 0; i < availableLevels.size(); i++) {
-                    if (newLevelName.getText() == availableLevels[i]) {
-                        levelExists = true;
-                    }
-                }
-                levelSelector.clearOptions();
-                availableLevels.clear();
+                // ask the disk directly, the index may be a scan behind
+                bool levelExists = filesystem::exists("levels/" + newLevelName.getText() + ".lvl");
                 
                 if (!levelExists) {
                     levelFilename = newLevelName.getText();
+                    levelFromPack = false;
                     
                     creatingLevel = false;
                     titleOptions.setActive(true);
@@ -584,10 +805,10 @@ bool updateMenu(KeyboardLayout *keys, char pressedLetters[], int numPressedLette
                     
                     level.setStartPos(32, (MAP_HEIGHT - 2) * PLATFORM_HEIGHT);
                     level.setEndPos(96, (MAP_HEIGHT - 2) * PLATFORM_HEIGHT);
-                    level.setFastestTime(-1);
                     level.resetLevel();
                     
-                    level.saveLevel(levelFilename);
+                    level.saveLevel(levelFilename, &fileWriter);
+                    loadFastestTime();
                     
                     newLevelName.reset();
                 }
@@ -608,24 +829,49 @@ bool updateMenu(KeyboardLayout *keys, char pressedLetters[], int numPressedLette
             titleOptions.setActive(true);
         }
     } else if (selectingLevel) {
-        if (availableLevels.size() == 0 || keys->getBackState() == PRESSED) {
+        updateAvailableLevels();
+        
+        // an empty list might still be filling in from the first scan
+        if ((availableLevels.size() == 0 && !levelIndex.isScanning()) || keys->getBackState() == PRESSED) {
             selectingLevel = false;
             titleOptions.setActive(true);
             levelSelector.setActive(false);
-            
-            levelSelector.clearOptions();
-            availableLevels.clear();
         }
         
-        if (keys->getConfirmState() == PRESSED) {
-            levelFilename = availableLevels[levelSelector.getSelection()].string();
-            level.loadLevel(levelFilename);
+        if (keys->getConfirmState() == PRESSED && levelSelector.getSelection() < static_cast<int>(availableLevels.size())) {
+            LevelIndexEntry *entry = &availableLevels[levelSelector.getSelection()];
+            bool loaded;
             
-            player.setPos(level.getStartX(), level.getStartY());
-            
-            currentGameState = GAME;
+            if (!entry->pack.empty()) {
+                string packFilename = "levels/" + entry->pack + PACK_EXTENSION;
+                string packedName = entry->name.substr(entry->pack.size() + 1);
+                
+                if (levelPack.getFilename() != packFilename && !levelPack.open(packFilename)) {
+                    loaded = false;
+                } else {
+                    int packedLevel = levelPack.find(packedName);
+                    if (packedLevel < 0) {
+                        printf("Couldn't load level. Error: no %s in level pack %s\n", packedName.c_str(), packFilename.c_str());
+                    }
+                    
+                    loaded = packedLevel >= 0 && level.loadPackedLevel(&levelPack, packedLevel);
+                }
+            } else {
+                // the level might still be on its way to disk from the last time it was played
+                fileWriter.flush();
+                loaded = level.loadLevel(entry->name);
+            }
             
-            resetLevel(false);
+            // stay on the selector; playing (or editing, and then saving over the file) whatever
+            // was loaded before under this level's name would be worse
+            if (loaded) {
+                levelFilename = entry->name;
+                levelFromPack = !entry->pack.empty();
+                
+                startLevel();
+            } else {
+                printf("Couldn't start level %s\n", entry->name.c_str());
+            }
         }
         
         levelSelector.update(keys);
@@ -639,6 +885,10 @@ bool updateMenu(KeyboardLayout *keys, char pressedLetters[], int numPressedLette
         titleOptions.setActive(false);
         levelSelector.setActive(true);
         
+        // show what's cached right away and let the rescan stream in. the fastest times shown may
+        // have changed since the labels were made, even if no level did
+        levelIndex.refresh();
+        shownLevelIndexGeneration = -1;
         updateAvailableLevels();
     } else if (titleOptionsSelection == 2) {
         return false;
@@ -648,16 +898,88 @@ bool updateMenu(KeyboardLayout *keys, char pressedLetters[], int numPressedLette
 }
 
 void updateAvailableLevels() {
-    for (auto const& dir_entry : std::filesystem::directory_iterator("levels")) {
-        if (dir_entry.path().extension() == ".lvl") {
-            availableLevels.push_back(dir_entry.path().filename().replace_extension(""));
-            levelSelector.addOption((availableLevels.end()-1)->string(), 0xFF, 0xFF, 0xFF, 0xFF);
+    int generation = levelIndex.getGeneration();
+    if (generation == shownLevelIndexGeneration) {
+        return;
+    }
+    shownLevelIndexGeneration = generation;
+    
+    // keep the cursor on the same level as entries come and go around it
+    string selectedName;
+    if (levelSelector.getSelection() < static_cast<int>(availableLevels.size())) {
+        selectedName = availableLevels[levelSelector.getSelection()].name;
+    }
+    
+    int numberOfOptions = static_cast<int>(availableLevels.size());
+    levelIndex.getEntries(&availableLevels);
+    int numberOfLevels = static_cast<int>(availableLevels.size());
+    
+    // only rebuild every option when something was removed; otherwise relabel and append
+    if (numberOfLevels < numberOfOptions) {
+        levelSelector.clearOptions();
+        numberOfOptions = 0;
+    }
+    
+    int selection = 0;
+    for (int i = 0; i < numberOfLevels; i++) {
+        if (i < numberOfOptions) {
+            levelSelector.editOptionText(i, getLevelOptionText(&availableLevels[i]));
+        } else {
+            levelSelector.addOption(getLevelOptionText(&availableLevels[i]), 0xFF, 0xFF, 0xFF, 0xFF);
+        }
+        
+        if (availableLevels[i].name == selectedName) {
+            selection = i;
         }
     }
+    levelSelector.setSelection(selection);
+}
+
+string getLevelOptionText(LevelIndexEntry *entry) {
+    char s[50];
+    
+    // the time is looked up rather than kept in the index, so it's never older than the score store
+    double fastestTime = scores.getFastestTime(entry->contentHash);
+    if (fastestTime < 0) {
+        snprintf(s, 50, "  %dx%d", entry->width, entry->height);
+    } else {
+        snprintf(s, 50, "  %dx%d  %.3f secs", entry->width, entry->height, fastestTime);
+    }
+    
+    return entry->name + s;
+}
+
+bool isLevelEditable() {
+    // streamed levels are never all in memory, and packed ones have no file of their own to save to
+    return !level.isStreaming() && !levelFromPack;
+}
+
+void loadFastestTime() {
+    // levels from before the score store kept their time in a file of their own
+    scores.importScoreFile(levelFilename, level.getContentHash());
+    
+    level.setFastestTime(scores.getFastestTime(level.getContentHash()));
+}
+
+void startLevel() {
+    loadFastestTime();
+    
+    if (levelMemoryReport) {
+        levelMemoryReport->beginSection("level " + levelFilename + ", just loaded");
+        level.reportMemory(levelMemoryReport);
+    }
+    
+    player.setPos(level.getStartX(), level.getStartY());
+    
+    currentGameState = GAME;
+    
+    resetLevel(false);
 }
 
 void resetLevel(bool animate) {
-    player.stop();
+    playerSettled = false;
+    
+    player.reset();
     player.destroyRope();
     player.destroyGrappleSeeker();
     
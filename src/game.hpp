@@ -11,6 +11,8 @@
 
 #include <string>
 #include "controls.hpp"
+#include "snapshot.hpp"
+#include "watchdog.hpp"
 using namespace std;
 
 enum GameMode {
@@ -23,6 +25,16 @@ enum GameMode {
     LEVEL_RESET
 };
 
+const string GAME_MODE_STRINGS[7] = {
+    "MENU",
+    "LEVEL SELECTOR",
+    "PAUSE",
+    "GAME",
+    "LEVEL EDITOR",
+    "LEVEL END",
+    "LEVEL RESET"
+};
+
 enum LevelEditorMode {
     PLATFORM,
     START_POINT,
@@ -41,7 +53,36 @@ const string EDITOR_MODE_STRINGS[3] = {
 bool gameInit();
 void gameCleanUp();
 
+// just enough for gameUpdate to play a level with nothing drawing it, for replays: no level index,
+// file writer or score log
+bool gameInitHeadless();
+
+// loads levels/<name>.lvl and starts playing it, as picking it from the menu would
+bool gameStartLevel(string name);
+
+// a loose level is being played rather than edited, so it can be recorded and started again with gameStartLevel
+bool gameIsPlayingLevelFile();
+string gameGetLevelName();
+
+// gameUpdate and gameSnapshot run on the simulation thread, gameDraw on the render thread
 bool gameUpdate(KeyboardLayout *keys, char pressedLetters[], int numPressedLetters);
-void gameDraw(SDL_Renderer *renderer);
+void gameSnapshot(RenderSnapshot *snapshot);
+void gameDraw(SDL_Renderer *renderer, RenderSnapshot *snapshot);
+
+// what getFrameContext would copy out of a snapshot, straight from the game. simulation thread only
+void gameGetFrameContext(FrameContext *context);
+
+// the lock both threads take around the screen text. the fonts and text texture counts behind it are
+// shared with any other text, so whatever else draws text (the performance overlay) takes it too
+void gameLockUi();
+void gameUnlockUi();
+
+// a section for the level, the player's rope and the text. it reads both threads' state, so only
+// call it while neither is running
+void gameReportMemory(MemoryReport *report);
+
+// from now on every level started adds a section to report with what it holds just loaded, so there's
+// a footprint for each level played and not just the last. set it before the simulation thread starts
+void gameRecordLevelMemory(MemoryReport *report);
 
 #endif
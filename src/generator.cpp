@@ -0,0 +1,280 @@
+#include <stdio.h>
+#include <filesystem>
+
+#include "generator.hpp"
+#include "filewriter.hpp"
+
+enum GeneratedRow {
+    FILLER_ROW,
+    CORRIDOR_ROW,
+    FLOOR_ROW
+};
+
+// splitmix64, rather than <random>, so a seed makes the same level whatever the compiler and library
+Uint64 nextRandom(Uint64 *state) {
+    Uint64 z = (*state += 0x9E3779B97F4A7C15ULL);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
+
+int randomBetween(Uint64 *state, int low, int high) {
+    return low + static_cast<int>(nextRandom(state) % static_cast<Uint64>(high - low + 1));
+}
+
+void setTile(Uint8 *tiles, int width, int x, int y, int value) {
+    size_t tile = static_cast<size_t>(y) * width + x;
+    int shift = (tile % 2) * 4;
+    
+    tiles[tile / 2] &= ~(0x0F << shift);
+    tiles[tile / 2] |= value << shift;
+}
+
+void setDefaultGeneratorSettings(LevelGeneratorSettings *settings) {
+    settings->width = 200;
+    settings->height = 100;
+    
+    settings->density = 0.15;
+    
+    settings->typeWeights[NORMAL] = 6;
+    settings->typeWeights[METAL] = 2;
+    settings->typeWeights[ICE] = 1;
+    settings->typeWeights[LAVA] = 1;
+    
+    settings->corridorHeight = 4;
+    settings->corridorSpacing = 12;
+    settings->shaftWidth = 2;
+    
+    settings->seed = 1;
+}
+
+bool parseGeneratorSetting(string setting, LevelGeneratorSettings *settings) {
+    size_t equals = setting.find('=');
+    if (equals == string::npos) {
+        printf("Couldn't parse generator setting %s. Error: expected name=value\n", setting.c_str());
+        return false;
+    }
+    
+    string name = setting.substr(0, equals);
+    const char *value = setting.c_str() + equals + 1;
+    
+    // the extra %c only matches if there's something left over after the number
+    char extra;
+    int matched = 0;
+    
+    if (name == "width") {
+        matched = sscanf(value, "%d%c", &settings->width, &extra);
+    } else if (name == "height") {
+        matched = sscanf(value, "%d%c", &settings->height, &extra);
+    } else if (name == "density") {
+        matched = sscanf(value, "%lf%c", &settings->density, &extra);
+    } else if (name == "types") {
+        int *weights = settings->typeWeights;
+        matched = sscanf(value, "%d,%d,%d,%d%c", weights + NORMAL, weights + METAL, weights + ICE, weights + LAVA, &extra) == 4 ? 1 : 0;
+    } else if (name == "corridor") {
+        matched = sscanf(value, "%d%c", &settings->corridorHeight, &extra);
+    } else if (name == "spacing") {
+        matched = sscanf(value, "%d%c", &settings->corridorSpacing, &extra);
+    } else if (name == "shaft") {
+        matched = sscanf(value, "%d%c", &settings->shaftWidth, &extra);
+    } else if (name == "seed") {
+        unsigned long long seed;
+        matched = sscanf(value, "%llu%c", &seed, &extra);
+        settings->seed = seed;
+    } else {
+        printf("Couldn't parse generator setting %s. Error: unknown setting\n", setting.c_str());
+        return false;
+    }
+    
+    if (matched != 1) {
+        printf("Couldn't parse generator setting %s. Error: bad value\n", setting.c_str());
+        return false;
+    }
+    
+    return true;
+}
+
+bool checkGeneratorSettings(LevelGeneratorSettings *settings) {
+    if (settings->width < MAP_WIDTH || settings->height < MAP_HEIGHT || settings->width > MAX_LEVEL_DIMENSION || settings->height > MAX_LEVEL_DIMENSION) {
+        printf("Couldn't generate level. Error: size must be between %dx%d and %dx%d tiles\n", MAP_WIDTH, MAP_HEIGHT, MAX_LEVEL_DIMENSION, MAX_LEVEL_DIMENSION);
+        return false;
+    }
+    
+    if (settings->density < 0 || settings->density > 1) {
+        printf("Couldn't generate level. Error: density must be between 0 and 1\n");
+        return false;
+    }
+    
+    int totalWeight = 0;
+    for (int i = 0; i < NUMBER_OF_PLATFORM_TYPES; i++) {
+        if (settings->typeWeights[i] < 0) {
+            printf("Couldn't generate level. Error: negative weight for %s\n", PLATFORM_TYPE_STRINGS[i].c_str());
+            return false;
+        }
+        
+        totalWeight += settings->typeWeights[i];
+    }
+    
+    if (totalWeight == 0 && settings->density > 0) {
+        printf("Couldn't generate level. Error: every platform type has weight 0\n");
+        return false;
+    }
+    
+    if (settings->corridorHeight < 0 || (settings->corridorHeight > 0 && settings->corridorSpacing < settings->corridorHeight + 2)) {
+        printf("Couldn't generate level. Error: corridors need a spacing of at least their height + 2\n");
+        return false;
+    }
+    
+    // the shafts stay clear of the start and end columns
+    if (settings->corridorHeight > 0 && (settings->shaftWidth < 1 || settings->shaftWidth > settings->width - 4)) {
+        printf("Couldn't generate level. Error: shaft width must be between 1 and %d\n", settings->width - 4);
+        return false;
+    }
+    
+    return true;
+}
+
+// tiles packed the way "B" files store them, or NULL if the settings are bad. start and end are in
+// pixels. the caller deletes the returned array
+Uint8 *generateTiles(LevelGeneratorSettings *settings, int *startX, int *startY, int *endX, int *endY) {
+    if (!checkGeneratorSettings(settings)) {
+        return NULL;
+    }
+    
+    int width = settings->width;
+    int height = settings->height;
+    
+    Uint8 *tiles = new Uint8[(static_cast<size_t>(width) * height + 1) / 2]();
+    
+    Uint64 random = settings->seed;
+    
+    // the top 32 bits of a random number decide whether there's a platform and the bottom 16 its type
+    Uint64 densityThreshold = static_cast<Uint64>(settings->density * 4294967296.0);
+    
+    int totalWeight = 0;
+    for (int i = 0; i < NUMBER_OF_PLATFORM_TYPES; i++) {
+        totalWeight += settings->typeWeights[i];
+    }
+    
+    Uint64 typeThresholds[NUMBER_OF_PLATFORM_TYPES];
+    int weightSoFar = 0;
+    for (int i = 0; i < NUMBER_OF_PLATFORM_TYPES; i++) {
+        weightSoFar += settings->typeWeights[i];
+        typeThresholds[i] = totalWeight > 0 ? static_cast<Uint64>(weightSoFar) * 65536 / totalWeight : 0;
+    }
+    
+    // only corridors with room for their floor count
+    int numberOfCorridors = 0;
+    if (settings->corridorHeight > 0 && height >= settings->corridorHeight + 2) {
+        numberOfCorridors = (height - settings->corridorHeight - 2) / settings->corridorSpacing + 1;
+    }
+    
+    for (int y = 0; y < height; y++) {
+        int row = FILLER_ROW;
+        if (numberOfCorridors > 0 && y / settings->corridorSpacing < numberOfCorridors) {
+            int bandRow = y % settings->corridorSpacing;
+            if (bandRow >= 1 && bandRow <= settings->corridorHeight) {
+                row = CORRIDOR_ROW;
+            } else if (bandRow == settings->corridorHeight + 1) {
+                row = FLOOR_ROW;
+            }
+        }
+        
+        if (row == CORRIDOR_ROW) {
+            continue;
+        }
+        
+        size_t tile = static_cast<size_t>(y) * width;
+        for (int x = 0; x < width; x++, tile++) {
+            int type = NORMAL;
+            
+            if (row == FILLER_ROW) {
+                Uint64 r = nextRandom(&random);
+                if ((r >> 32) >= densityThreshold) {
+                    continue;
+                }
+                
+                type = 0;
+                while (type < NUMBER_OF_PLATFORM_TYPES - 1 && (r & 0xFFFF) >= typeThresholds[type]) {
+                    type++;
+                }
+            }
+            
+            tiles[tile / 2] |= (type + 1) << ((tile % 2) * 4);
+        }
+    }
+    
+    if (numberOfCorridors > 0) {
+        // a shaft from each corridor down through its floor into the next one
+        for (int i = 0; i + 1 < numberOfCorridors; i++) {
+            int shaftX = randomBetween(&random, 2, width - 2 - settings->shaftWidth);
+            int top = i * settings->corridorSpacing + 1;
+            int bottom = (i + 1) * settings->corridorSpacing + settings->corridorHeight;
+            
+            for (int y = top; y <= bottom; y++) {
+                for (int x = shaftX; x < shaftX + settings->shaftWidth; x++) {
+                    setTile(tiles, width, x, y, 0);
+                }
+            }
+        }
+        
+        // standing on the floor at either end of the first and last corridors
+        *startX = 1 * PLATFORM_WIDTH;
+        *startY = settings->corridorHeight * PLATFORM_HEIGHT;
+        *endX = (width - 2) * PLATFORM_WIDTH;
+        *endY = ((numberOfCorridors - 1) * settings->corridorSpacing + settings->corridorHeight) * PLATFORM_HEIGHT;
+    } else {
+        // along the top and down the right hand side
+        for (int x = 0; x < width; x++) {
+            setTile(tiles, width, x, 0, 0);
+        }
+        
+        for (int y = 0; y < height; y++) {
+            setTile(tiles, width, width - 1, y, 0);
+        }
+        
+        *startX = 0;
+        *startY = 0;
+        *endX = (width - 1) * PLATFORM_WIDTH;
+        *endY = (height - 1) * PLATFORM_HEIGHT;
+    }
+    
+    return tiles;
+}
+
+bool generateLevel(Level *level, LevelGeneratorSettings *settings) {
+    int startX, startY, endX, endY;
+    
+    Uint8 *tiles = generateTiles(settings, &startX, &startY, &endX, &endY);
+    if (!tiles) {
+        return false;
+    }
+    
+    level->loadTiles(tiles, settings->width, settings->height, startX, startY, endX, endY);
+    
+    delete[] tiles;
+    return true;
+}
+
+bool generateLevelFile(string name, LevelGeneratorSettings *settings) {
+    int startX, startY, endX, endY;
+    
+    Uint8 *tiles = generateTiles(settings, &startX, &startY, &endX, &endY);
+    if (!tiles) {
+        return false;
+    }
+    
+    string contents;
+    Level::encodeTiles(&contents, tiles, settings->width, settings->height, startX, startY, endX, endY);
+    delete[] tiles;
+    
+    // this runs before the game has made the levels directory, which a fresh build doesn't have yet
+    error_code error;
+    filesystem::create_directories("levels", error);
+    if (error) {
+        printf("Couldn't generate level. Error: couldn't create levels directory: %s\n", error.message().c_str());
+        return false;
+    }
+    
+    return writeFileAtomically("levels/" + name + ".lvl", contents);
+}
@@ -0,0 +1,50 @@
+#ifndef generator_hpp
+#define generator_hpp
+
+#if defined __APPLE__ || defined __linux__
+#include <SDL2/SDL.h>
+#endif
+
+#ifdef _WIN64
+#include <SDL.h>
+#endif
+
+#include <string>
+using namespace std;
+
+#include "level.hpp"
+
+// synthetic levels for benchmarks and soak tests. the same settings and seed always make the same level
+struct LevelGeneratorSettings {
+    int width;      // in tiles
+    int height;
+    
+    // chance of each tile between the corridors being a platform
+    double density;
+    
+    // relative chance of each platform type, in PlatformTypes order
+    int typeWeights[NUMBER_OF_PLATFORM_TYPES];
+    
+    // every corridorSpacing rows there's a corridor corridorHeight tiles high with a floor under it,
+    // joined to the next one down by a shaft shaftWidth tiles wide. with corridorHeight 0 there
+    // are no corridors and just a path is carved from start to end
+    int corridorHeight;
+    int corridorSpacing;
+    int shaftWidth;
+    
+    Uint64 seed;
+};
+
+void setDefaultGeneratorSettings(LevelGeneratorSettings *settings);
+
+// one "name=value" setting, as given on the command line (width, height, density, types, corridor,
+// spacing, shaft, seed). types is four comma separated weights
+bool parseGeneratorSetting(string setting, LevelGeneratorSettings *settings);
+
+// the start is in the first corridor and the end in the last, with empty tiles all the way between
+bool generateLevel(Level *level, LevelGeneratorSettings *settings);
+
+// straight to levels/<name>.lvl as a "B" file, without building the platforms in memory
+bool generateLevelFile(string name, LevelGeneratorSettings *settings);
+
+#endif
@@ -1,18 +1,19 @@
+#include <algorithm>
 #include <cmath>
 
 #include "grapple.hpp"
 #include "player.hpp"
+#include "profiler.hpp"
+#include "stats.hpp"
+#include "memory.hpp"
 
 #ifdef _WIN64
 #define M_PI_2 M_PI/2
 #define M_PI_4 M_PI/4
 #endif
 
-// from the internet. see definition at the bottom of this file (modified)
-CollisionReportContainer *getLineRectangleCollision(float x1, float y1, float x2, float y2, float rx, float ry, float rw, float rh);
-CollisionReport *getLineCollision(float x1, float y1, float x2, float y2, float x3, float y3, float x4, float y4);
-bool checkLineRectCollision(float x1, float y1, float x2, float y2, float rx, float ry, float rw, float rh);
-bool checkLineCollision(float x1, float y1, float x2, float y2, float x3, float y3, float x4, float y4);
+// the rope can't reach further than MAX_ROPE_LENGTH from the player, so that's all a streamed level needs loaded
+void requireRopeArea(Player *player, Level *level);
 
 CollisionReport::CollisionReport() {
     _intersectionX = 0;
@@ -97,22 +98,23 @@ void CollisionReportContainer::clear() {
 GrappleSeeker::GrappleSeeker(Player *player, double angle) {
     _player = player;
     
+    reset(angle);
+}
+
+GrappleSeeker::~GrappleSeeker() {
+}
+
+void GrappleSeeker::reset(double angle) {
     _angle = angle;
     
-    _x = player->getX() + player->getWidth() / 2;
-    _y = player->getY() + player->getHeight() / 2;
+    _x = _player->getX() + _player->getWidth() / 2;
+    _y = _player->getY() + _player->getHeight() / 2;
     _velocityX = SEEK_SPEED * cos(_angle);
     _velocityY = SEEK_SPEED * sin(_angle);
     
     _extending = true;
     
-    _pivots = new Pivot[10];
-    _numberOfPivots = 0;
-    _pivotsCapacity = 10;
-}
-
-GrappleSeeker::~GrappleSeeker() {
-    delete[] _pivots;
+    _pivots.clear();
 }
 
 void GrappleSeeker::addVelocityX(double vX) {
@@ -123,8 +125,12 @@ void GrappleSeeker::addVelocityY(double vY) {
     _velocityY += vY;
 }
 
+int GrappleSeeker::getNumberOfPivots() {
+    return _pivots.getNumberOfPivots();
+}
+
 double GrappleSeeker::getCurrentLength() {
-    if (_numberOfPivots == 0) {
+    if (_pivots.getNumberOfPivots() == 0) {
         double diffX = _x - (_player->getX() + _player->getWidth() / 2);
         double diffY = _y - (_player->getY() + _player->getHeight() / 2);
         
@@ -132,24 +138,24 @@ double GrappleSeeker::getCurrentLength() {
     }
     
     double sum = 0;
-    double diffX = _x - _pivots[0].getX();
-    double diffY = _y - _pivots[0].getY();
+    double diffX = _x - _pivots.getPivot(0)->getX();
+    double diffY = _y - _pivots.getPivot(0)->getY();
     sum += sqrt(pow(diffX, 2) + pow(diffY, 2));
     
-    for (int i = 1; i < _numberOfPivots; i++) {
-        diffX = _pivots[i - 1].getX() - _pivots[i].getX();
-        diffY = _pivots[i - 1].getY() - _pivots[i].getY();
+    for (int i = 1; i < _pivots.getNumberOfPivots(); i++) {
+        diffX = _pivots.getPivot(i - 1)->getX() - _pivots.getPivot(i)->getX();
+        diffY = _pivots.getPivot(i - 1)->getY() - _pivots.getPivot(i)->getY();
         sum += sqrt(pow(diffX, 2) + pow(diffY, 2));
     }
-        
-    diffX = _pivots[_numberOfPivots - 1].getX() - (_player->getX() + _player->getWidth() / 2);
-    diffY = _pivots[_numberOfPivots - 1].getY() - (_player->getY() + _player->getHeight() / 2);
+    
+    diffX = _pivots.getLast()->getX() - (_player->getX() + _player->getWidth() / 2);
+    diffY = _pivots.getLast()->getY() - (_player->getY() + _player->getHeight() / 2);
     sum += sqrt(pow(diffX, 2) + pow(diffY, 2));
     
     return sum;
 }
 
-CollisionReport *GrappleSeeker::collide(Platform *p) {
+bool GrappleSeeker::collide(Platform *p, CollisionReport *closestCollision) {
     float x1 = _x /*- _player->getVelocityX()*/;
     float y1 = _y /*- _player->getVelocityY()*/;
     float x2 = _x + _velocityX;
@@ -160,37 +166,34 @@ CollisionReport *GrappleSeeker::collide(Platform *p) {
     float rw = p->getWidth();
     float rh = p->getHeight();
     
-    CollisionReportContainer *collisions = getLineRectangleCollision(x1, y1, x2, y2, rx, ry, rw, rh);
-    if (collisions->getNumberOfReports() == 0) {
-        delete collisions;
-        return NULL;
+    getLineRectangleCollision(x1, y1, x2, y2, rx, ry, rw, rh, &_platformCollisions);
+    if (_platformCollisions.getNumberOfReports() == 0) {
+        return false;
     }
     
-    CollisionReport *closestCollision = NULL;
+    CollisionReport *closest = NULL;
     double closestCollisionDistance = 0;
     
-    for (int i = 0; i < collisions->getNumberOfReports(); i++) {
-        CollisionReport *currentCollisionReport = collisions->getReport(i);
+    for (int i = 0; i < _platformCollisions.getNumberOfReports(); i++) {
+        CollisionReport *currentCollisionReport = _platformCollisions.getReport(i);
         currentCollisionReport->setPlatform(p);
         double diffX = _player->getX() - currentCollisionReport->getIntersectionX();
         double diffY = _player->getY() - currentCollisionReport->getIntersectionY();
         double distance = sqrt(pow(diffX, 2) + pow(diffY, 2));
         
-        if (closestCollision) {
+        if (closest) {
             if ((_extending && distance < closestCollisionDistance) || (!_extending && distance > closestCollisionDistance)) {
-                closestCollision = currentCollisionReport;
+                closest = currentCollisionReport;
                 closestCollisionDistance = distance;
             }
         } else {
-            closestCollision = currentCollisionReport;
+            closest = currentCollisionReport;
             closestCollisionDistance = distance;
         }
     }
     
-    closestCollision = new CollisionReport(closestCollision->getIntersectionX(), closestCollision->getIntersectionY(), closestCollision->getPlatform());
-    
-    delete collisions;
-    return closestCollision;
+    *closestCollision = *closest;
+    return true;
 }
 
 //bool rectsOverlap(double x1, double y1, int w1, int h1, double x2, double y2, int w2, int h2) {
@@ -203,41 +206,36 @@ CollisionReport *GrappleSeeker::collide(Platform *p) {
 //}
 
 void GrappleSeeker::removeFirstPivot() {
-    if (_numberOfPivots > 0) {
-        for (int i = 1; i < _numberOfPivots; i++) {
-            _pivots[i - 1].setX(_pivots[i].getX());
-            _pivots[i - 1].setY(_pivots[i].getY());
-            _pivots[i - 1].setDrawX(_pivots[i].getDrawX());
-            _pivots[i - 1].setDrawY(_pivots[i].getDrawY());
-            _pivots[i - 1].setAttachAngle(_pivots[i].getAttachAngle());
-            _pivots[i - 1].setPivotPlatform(_pivots[i - 1].getPivotPlatform());
-        }
-        _numberOfPivots--;
-    }
+    _pivots.removeFirst();
 }
 
 bool GrappleSeeker::seek(Level *level) {
-    CollisionReportContainer container;
+    PROFILE_ZONE("GrappleSeeker::seek");
+    COUNT_STAT(SEEKER_STEPS, 1);
+    
+    requireRopeArea(_player, level);
     
+    _collisions.clear();
+    
+    COUNT_STAT(PLATFORM_SCANS, 1);
+    COUNT_STAT(PLATFORMS_TESTED, level->getNumberOfPlatforms());
     for (int i = 0; i < level->getNumberOfPlatforms(); i++) {
-        CollisionReport *newCollision = collide(level->getPlatform(i));
+        CollisionReport newCollision;
         
-        if (newCollision) {
-            container.addReport(newCollision->getIntersectionX(), newCollision->getIntersectionY());
-            container.getReport(container.getNumberOfReports() - 1)->setPlatform(newCollision->getPlatform());
-            
-            delete newCollision;
+        if (collide(level->getPlatform(i), &newCollision)) {
+            _collisions.addReport(newCollision.getIntersectionX(), newCollision.getIntersectionY());
+            _collisions.getReport(_collisions.getNumberOfReports() - 1)->setPlatform(newCollision.getPlatform());
         }
     }
     
-    if (container.getNumberOfReports() == 0) {
+    if (_collisions.getNumberOfReports() == 0) {
         if (_extending) {
             _velocityX = SEEK_SPEED * cos(_angle);
             _velocityY = SEEK_SPEED * sin(_angle);
         } else {
-            if (_numberOfPivots > 0) {
-                _returnX = _pivots[0].getX();
-                _returnY = _pivots[0].getY();
+            if (_pivots.getNumberOfPivots() > 0) {
+                _returnX = _pivots.getPivot(0)->getX();
+                _returnY = _pivots.getPivot(0)->getY();
             } else {
                 _returnX = _player->getX() + _player->getWidth() / 2;
                 _returnY = _player->getY() + _player->getHeight() / 2;
@@ -246,11 +244,11 @@ bool GrappleSeeker::seek(Level *level) {
             double diffX = _returnX - _x;
             double diffY = _returnY - _y;
             
-            if (_numberOfPivots != 0) {
+            if (_pivots.getNumberOfPivots() != 0) {
                 double pivotDistance = sqrt(pow(diffX, 2) + pow(diffY, 2));
                 if (pivotDistance <= sqrt(pow(_velocityX, 2) + pow(_velocityY, 2))) {
-                    if (_pivots[0].getPivotPlatform()->getType() != METAL && _pivots[0].getPivotPlatform()->getType() != LAVA) {
-                        _player->createRope(_pivots[0].getX(), _pivots[0].getY());
+                    if (_pivots.getPivot(0)->getPivotPlatform()->getType() != METAL && _pivots.getPivot(0)->getPivotPlatform()->getType() != LAVA) {
+                        _player->createRope(_pivots.getPivot(0)->getX(), _pivots.getPivot(0)->getY());
                         return true;
                     } else {
                         removeFirstPivot();
@@ -281,8 +279,8 @@ bool GrappleSeeker::seek(Level *level) {
     CollisionReport *closestCollision = NULL;
     double closestCollisionDistance = 0;
     
-    for (int i = 0; i < container.getNumberOfReports(); i++) {
-        CollisionReport *currentCollisionReport = container.getReport(i);
+    for (int i = 0; i < _collisions.getNumberOfReports(); i++) {
+        CollisionReport *currentCollisionReport = _collisions.getReport(i);
         double diffX = _player->getX() - currentCollisionReport->getIntersectionX();
         double diffY = _player->getY() - currentCollisionReport->getIntersectionY();
         double distance = sqrt(pow(diffX, 2) + pow(diffY, 2));
@@ -325,35 +323,26 @@ bool GrappleSeeker::seek(Level *level) {
         return false;
     }
     
+    // the rope's length is measured before it takes the pivots over, as it always has been
     _player->createRope(x, y);
-    
-    if (_numberOfPivots > 0) {
-        Pivot *playerRopePivots = _player->getRope()->getPivots();
-        for (int i = 0; i < _numberOfPivots; i++) {
-            playerRopePivots[i].setX(_pivots[i].getX());
-            playerRopePivots[i].setY(_pivots[i].getY());
-            playerRopePivots[i].setDrawX(_pivots[i].getDrawX());
-            playerRopePivots[i].setDrawY(_pivots[i].getDrawY());
-            playerRopePivots[i].setAttachAngle(_pivots[i].getAttachAngle());
-
-            _player->getRope()->setNumberOfPivots(i + 1);
-        }
-    }
+    _player->getRope()->takePivots(&_pivots);
     
     return true;
 }
 
 int GrappleSeeker::wrapCorners(Level *level) {
+    COUNT_STAT(PLATFORM_SCANS, 1);
+    COUNT_STAT(PLATFORMS_TESTED, level->getNumberOfPlatforms());
     for (int i = 0; i < level->getNumberOfPlatforms(); i++) {
         double x1, y1, x2, y2;
         double rx, ry, rw, rh;
         
-        if (_numberOfPivots == 0) {
+        if (_pivots.getNumberOfPivots() == 0) {
             x1 = _x;
             y1 = _y;
         } else {
-            x1 = _pivots[_numberOfPivots - 1].getX();
-            y1 = _pivots[_numberOfPivots - 1].getY();
+            x1 = _pivots.getLast()->getX();
+            y1 = _pivots.getLast()->getY();
         }
         
         x2 = _player->getX() + _player->getWidth() / 2;
@@ -366,6 +355,8 @@ int GrappleSeeker::wrapCorners(Level *level) {
         
         if (checkLineRectCollision(x1, y1, x2, y2, rx, ry, rw, rh)) {
             // collision
+            Pivot pivot;
+            
             bool left = false;
             bool right = false;
             bool top = false;
@@ -441,94 +432,94 @@ int GrappleSeeker::wrapCorners(Level *level) {
             bool valuesSet = false;
             if ((left && !bottom && movingUp && playerRight && !playerTop && platformBottom) || (bottom && !left && movingRight && playerTop && !playerRight && platformLeft)) {    // left/~bottom and bottom/~left
                 // pivot @ bottom left
-                _pivots[_numberOfPivots].setX(level->getPlatform(i)->getX() - 2);
-                _pivots[_numberOfPivots].setY(level->getPlatform(i)->getY() + level->getPlatform(i)->getHeight() + 1);
-                _pivots[_numberOfPivots].setDrawX(level->getPlatform(i)->getX() - 1);
-                _pivots[_numberOfPivots].setDrawY(level->getPlatform(i)->getY() + level->getPlatform(i)->getHeight());
+                pivot.setX(level->getPlatform(i)->getX() - 2);
+                pivot.setY(level->getPlatform(i)->getY() + level->getPlatform(i)->getHeight() + 1);
+                pivot.setDrawX(level->getPlatform(i)->getX() - 1);
+                pivot.setDrawY(level->getPlatform(i)->getY() + level->getPlatform(i)->getHeight());
                 valuesSet = true;
             } else if ((top && !right && movingLeft && playerBottom && !playerLeft && platformRight) || (right && !top && movingDown && playerLeft && !playerBottom && platformTop)) {    // top/~right and right/~top
                 // pivot @ top right
-                _pivots[_numberOfPivots].setX(level->getPlatform(i)->getX() + level->getPlatform(i)->getWidth() + 1);
-                _pivots[_numberOfPivots].setY(level->getPlatform(i)->getY() - 2);
-                _pivots[_numberOfPivots].setDrawX(level->getPlatform(i)->getX() + level->getPlatform(i)->getWidth());
-                _pivots[_numberOfPivots].setDrawY(level->getPlatform(i)->getY() - 1);
+                pivot.setX(level->getPlatform(i)->getX() + level->getPlatform(i)->getWidth() + 1);
+                pivot.setY(level->getPlatform(i)->getY() - 2);
+                pivot.setDrawX(level->getPlatform(i)->getX() + level->getPlatform(i)->getWidth());
+                pivot.setDrawY(level->getPlatform(i)->getY() - 1);
                 valuesSet = true;
             } else if ((left && !top && movingDown && playerRight && !playerBottom && platformTop) || (top && !left && movingRight && playerBottom && !playerRight && platformLeft)) {   // left/~top and top/~left
                 // pivot @ top left
-                _pivots[_numberOfPivots].setX(level->getPlatform(i)->getX() - 2);
-                _pivots[_numberOfPivots].setY(level->getPlatform(i)->getY() - 2);
-                _pivots[_numberOfPivots].setDrawX(level->getPlatform(i)->getX() - 1);
-                _pivots[_numberOfPivots].setDrawY(level->getPlatform(i)->getY() - 1);
+                pivot.setX(level->getPlatform(i)->getX() - 2);
+                pivot.setY(level->getPlatform(i)->getY() - 2);
+                pivot.setDrawX(level->getPlatform(i)->getX() - 1);
+                pivot.setDrawY(level->getPlatform(i)->getY() - 1);
                 valuesSet = true;
             } else if ((right && !bottom && movingUp && playerLeft && !playerTop && platformBottom) || (bottom && !right && movingLeft && playerTop && !playerLeft && platformRight)) {  // right/~bottom and bottom/~right
                 // pivot @ bottom right
-                _pivots[_numberOfPivots].setX(level->getPlatform(i)->getX() + level->getPlatform(i)->getWidth() + 1);
-                _pivots[_numberOfPivots].setY(level->getPlatform(i)->getY() + level->getPlatform(i)->getHeight() + 1);
-                _pivots[_numberOfPivots].setDrawX(level->getPlatform(i)->getX() + level->getPlatform(i)->getWidth());
-                _pivots[_numberOfPivots].setDrawY(level->getPlatform(i)->getY() + level->getPlatform(i)->getHeight());
+                pivot.setX(level->getPlatform(i)->getX() + level->getPlatform(i)->getWidth() + 1);
+                pivot.setY(level->getPlatform(i)->getY() + level->getPlatform(i)->getHeight() + 1);
+                pivot.setDrawX(level->getPlatform(i)->getX() + level->getPlatform(i)->getWidth());
+                pivot.setDrawY(level->getPlatform(i)->getY() + level->getPlatform(i)->getHeight());
                 valuesSet = true;
             } else if (top && movingDown) {
                 if (playerLeft) {
                     // pivot @ top left
-                    _pivots[_numberOfPivots].setX(level->getPlatform(i)->getX() - 2);
-                    _pivots[_numberOfPivots].setY(level->getPlatform(i)->getY() - 2);
-                    _pivots[_numberOfPivots].setDrawX(level->getPlatform(i)->getX() - 1);
-                    _pivots[_numberOfPivots].setDrawY(level->getPlatform(i)->getY() - 1);
+                    pivot.setX(level->getPlatform(i)->getX() - 2);
+                    pivot.setY(level->getPlatform(i)->getY() - 2);
+                    pivot.setDrawX(level->getPlatform(i)->getX() - 1);
+                    pivot.setDrawY(level->getPlatform(i)->getY() - 1);
                     valuesSet = true;
                 } else if (playerRight) {
                     // pivot @ top right
-                    _pivots[_numberOfPivots].setX(level->getPlatform(i)->getX() + level->getPlatform(i)->getWidth() + 1);
-                    _pivots[_numberOfPivots].setY(level->getPlatform(i)->getY() - 2);
-                    _pivots[_numberOfPivots].setDrawX(level->getPlatform(i)->getX() + level->getPlatform(i)->getWidth());
-                    _pivots[_numberOfPivots].setDrawY(level->getPlatform(i)->getY() - 1);
+                    pivot.setX(level->getPlatform(i)->getX() + level->getPlatform(i)->getWidth() + 1);
+                    pivot.setY(level->getPlatform(i)->getY() - 2);
+                    pivot.setDrawX(level->getPlatform(i)->getX() + level->getPlatform(i)->getWidth());
+                    pivot.setDrawY(level->getPlatform(i)->getY() - 1);
                     valuesSet = true;
                 }
             } else if (bottom && movingUp) {
                 if (playerLeft) {
                     // pivot @ bottom left
-                    _pivots[_numberOfPivots].setX(level->getPlatform(i)->getX() - 2);
-                    _pivots[_numberOfPivots].setY(level->getPlatform(i)->getY() + level->getPlatform(i)->getHeight() + 1);
-                    _pivots[_numberOfPivots].setDrawX(level->getPlatform(i)->getX() - 1);
-                    _pivots[_numberOfPivots].setDrawY(level->getPlatform(i)->getY() + level->getPlatform(i)->getHeight());
+                    pivot.setX(level->getPlatform(i)->getX() - 2);
+                    pivot.setY(level->getPlatform(i)->getY() + level->getPlatform(i)->getHeight() + 1);
+                    pivot.setDrawX(level->getPlatform(i)->getX() - 1);
+                    pivot.setDrawY(level->getPlatform(i)->getY() + level->getPlatform(i)->getHeight());
                     valuesSet = true;
                 } else if (playerRight) {
                     // pivot @ bottom right
-                    _pivots[_numberOfPivots].setX(level->getPlatform(i)->getX() + level->getPlatform(i)->getWidth() + 1);
-                    _pivots[_numberOfPivots].setY(level->getPlatform(i)->getY() + level->getPlatform(i)->getHeight() + 1);
-                    _pivots[_numberOfPivots].setDrawX(level->getPlatform(i)->getX() + level->getPlatform(i)->getWidth());
-                    _pivots[_numberOfPivots].setDrawY(level->getPlatform(i)->getY() + level->getPlatform(i)->getHeight());
+                    pivot.setX(level->getPlatform(i)->getX() + level->getPlatform(i)->getWidth() + 1);
+                    pivot.setY(level->getPlatform(i)->getY() + level->getPlatform(i)->getHeight() + 1);
+                    pivot.setDrawX(level->getPlatform(i)->getX() + level->getPlatform(i)->getWidth());
+                    pivot.setDrawY(level->getPlatform(i)->getY() + level->getPlatform(i)->getHeight());
                     valuesSet = true;
                 }
             } else if (left && movingRight) {
                 if (playerTop) {
                     // pivot @ top left
-                    _pivots[_numberOfPivots].setX(level->getPlatform(i)->getX() - 2);
-                    _pivots[_numberOfPivots].setY(level->getPlatform(i)->getY() - 2);
-                    _pivots[_numberOfPivots].setDrawX(level->getPlatform(i)->getX() - 1);
-                    _pivots[_numberOfPivots].setDrawY(level->getPlatform(i)->getY() - 1);
+                    pivot.setX(level->getPlatform(i)->getX() - 2);
+                    pivot.setY(level->getPlatform(i)->getY() - 2);
+                    pivot.setDrawX(level->getPlatform(i)->getX() - 1);
+                    pivot.setDrawY(level->getPlatform(i)->getY() - 1);
                     valuesSet = true;
                 } else if (playerBottom) {
                     // pivot @ bottom left
-                    _pivots[_numberOfPivots].setX(level->getPlatform(i)->getX() - 2);
-                    _pivots[_numberOfPivots].setY(level->getPlatform(i)->getY() + level->getPlatform(i)->getHeight() + 1);
-                    _pivots[_numberOfPivots].setDrawX(level->getPlatform(i)->getX() - 1);
-                    _pivots[_numberOfPivots].setDrawY(level->getPlatform(i)->getY() + level->getPlatform(i)->getHeight());
+                    pivot.setX(level->getPlatform(i)->getX() - 2);
+                    pivot.setY(level->getPlatform(i)->getY() + level->getPlatform(i)->getHeight() + 1);
+                    pivot.setDrawX(level->getPlatform(i)->getX() - 1);
+                    pivot.setDrawY(level->getPlatform(i)->getY() + level->getPlatform(i)->getHeight());
                     valuesSet = true;
                 }
             } else if (right && movingLeft) {
                 if (playerTop) {
                     // pivot @ top right
-                    _pivots[_numberOfPivots].setX(level->getPlatform(i)->getX() + level->getPlatform(i)->getWidth() + 1);
-                    _pivots[_numberOfPivots].setY(level->getPlatform(i)->getY() - 2);
-                    _pivots[_numberOfPivots].setDrawX(level->getPlatform(i)->getX() + level->getPlatform(i)->getWidth());
-                    _pivots[_numberOfPivots].setDrawY(level->getPlatform(i)->getY() - 1);
+                    pivot.setX(level->getPlatform(i)->getX() + level->getPlatform(i)->getWidth() + 1);
+                    pivot.setY(level->getPlatform(i)->getY() - 2);
+                    pivot.setDrawX(level->getPlatform(i)->getX() + level->getPlatform(i)->getWidth());
+                    pivot.setDrawY(level->getPlatform(i)->getY() - 1);
                     valuesSet = true;
                 } else if (playerBottom) {
                     // pivot @ bottom right
-                    _pivots[_numberOfPivots].setX(level->getPlatform(i)->getX() + level->getPlatform(i)->getWidth() + 1);
-                    _pivots[_numberOfPivots].setY(level->getPlatform(i)->getY() + level->getPlatform(i)->getHeight() + 1);
-                    _pivots[_numberOfPivots].setDrawX(level->getPlatform(i)->getX() + level->getPlatform(i)->getWidth());
-                    _pivots[_numberOfPivots].setDrawY(level->getPlatform(i)->getY() + level->getPlatform(i)->getHeight());
+                    pivot.setX(level->getPlatform(i)->getX() + level->getPlatform(i)->getWidth() + 1);
+                    pivot.setY(level->getPlatform(i)->getY() + level->getPlatform(i)->getHeight() + 1);
+                    pivot.setDrawX(level->getPlatform(i)->getX() + level->getPlatform(i)->getWidth());
+                    pivot.setDrawY(level->getPlatform(i)->getY() + level->getPlatform(i)->getHeight());
                     valuesSet = true;
                 }
             }
@@ -537,30 +528,19 @@ int GrappleSeeker::wrapCorners(Level *level) {
                 double diffX;
                 double diffY;
                 
-                if (_numberOfPivots) {
-                    diffX = _pivots[_numberOfPivots - 1].getX() - _pivots[_numberOfPivots].getX();
-                    diffY = _pivots[_numberOfPivots - 1].getY() - _pivots[_numberOfPivots].getY();
+                if (_pivots.getNumberOfPivots()) {
+                    diffX = _pivots.getLast()->getX() - pivot.getX();
+                    diffY = _pivots.getLast()->getY() - pivot.getY();
                 } else {
-                    diffX = _x - _pivots[_numberOfPivots].getX();
-                    diffY = _y - _pivots[_numberOfPivots].getY();
+                    diffX = _x - pivot.getX();
+                    diffY = _y - pivot.getY();
                 }
                 
-                _pivots[_numberOfPivots].setAttachAngle(atan2(diffY, diffX));
+                pivot.setAttachAngle(atan2(diffY, diffX));
                 
-                _pivots[_numberOfPivots].setPivotPlatform(level->getPlatform(i));
+                pivot.setPivotPlatform(level->getPlatform(i));
                 
-                _numberOfPivots++;
-                if (_numberOfPivots >= _pivotsCapacity) {
-                    _pivotsCapacity *= 2;
-                    Pivot *newPivots = new Pivot[_pivotsCapacity];
-                    for (int i = 0; i < _numberOfPivots; i++) {
-                        newPivots[i].setX(_pivots[i].getX());
-                        newPivots[i].setY(_pivots[i].getY());
-                    }
-                    delete[] _pivots;
-                    
-                    _pivots = newPivots;
-                }
+                *_pivots.addPivot() = pivot;
             }
         }
     }
@@ -568,27 +548,15 @@ int GrappleSeeker::wrapCorners(Level *level) {
     return -1;
 }
 
-void GrappleSeeker::draw(SDL_Renderer *renderer) {
-    draw(renderer, 0, 0);
+void GrappleSeeker::snapshot(GrappleSnapshot *grapple) {
+    grapple->setHook(_x, _y);
+    for (int i = 0; i < _pivots.getNumberOfPivots(); i++) {
+        grapple->addPivot(_pivots.getPivot(i)->getDrawX(), _pivots.getPivot(i)->getDrawY());
+    }
 }
 
-void GrappleSeeker::draw(SDL_Renderer *renderer, int cameraX, int cameraY) {
-    SDL_SetRenderDrawColor(renderer, 0x00, 0xFF, 0x00, 0xFF);
-    
-    if (_numberOfPivots > 0) {
-        SDL_RenderDrawLine(renderer, _x - cameraX, _y - cameraY, _pivots[0].getDrawX() - cameraX, _pivots[0].getDrawY() - cameraY);
-        for (int i = 1; i < _numberOfPivots; i++) {
-            SDL_RenderDrawLine(renderer, _pivots[i - 1].getDrawX() - cameraX, _pivots[i - 1].getDrawY() - cameraY, _pivots[i].getDrawX() - cameraX, _pivots[i].getDrawY() - cameraY);
-        }
-        SDL_RenderDrawLine(renderer, _pivots[_numberOfPivots - 1].getDrawX() - cameraX, _pivots[_numberOfPivots - 1].getDrawY() - cameraY, _player->getX() + _player->getWidth() / 2 - cameraX, _player->getY() + _player->getHeight() / 2 - cameraY);
-    } else {
-        SDL_RenderDrawLine(renderer, static_cast<int>(_player->getX() + _player->getWidth() / 2 - cameraX), static_cast<int>(_player->getY() + _player->getHeight() / 2 - cameraY), _x - cameraX, _y - cameraY);
-    }
-    
-    // square where the hook is
-    SDL_SetRenderDrawColor(renderer, 0x00, 0x00, 0xFF, 0xFF);
-    SDL_Rect grappleRect = { static_cast<int>(_x - cameraX) - GRAPPLE_RECT_HALF_WIDTH, static_cast<int>(_y - cameraY) - GRAPPLE_RECT_HALF_WIDTH, GRAPPLE_RECT_HALF_WIDTH * 2, GRAPPLE_RECT_HALF_WIDTH * 2 };
-    SDL_RenderFillRect(renderer, &grappleRect);
+void GrappleSeeker::reportMemory(MemoryReport *report) {
+    report->add(SEEKER_PIVOTS, _pivots.getNumberOfPivots() * sizeof(Pivot), _pivots.getCapacity() * sizeof(Pivot));
 }
 
 int Pivot::getX() {
@@ -639,24 +607,131 @@ double Pivot::getAttachAngle() {
     return _attachAngle;
 }
 
+PivotChain::PivotChain() {
+    _pivots = _inlinePivots;
+    _capacity = INLINE_PIVOTS;
+    
+    _first = 0;
+    _numberOfPivots = 0;
+}
+
+PivotChain::~PivotChain() {
+    if (_pivots != _inlinePivots) {
+        delete[] _pivots;
+    }
+}
+
+int PivotChain::getNumberOfPivots() {
+    return _numberOfPivots;
+}
+
+int PivotChain::getCapacity() {
+    return _capacity;
+}
+
+Pivot *PivotChain::getPivot(int i) {
+    return _pivots + ((_first + i) & (_capacity - 1));
+}
+
+Pivot *PivotChain::getLast() {
+    return getPivot(_numberOfPivots - 1);
+}
+
+Pivot *PivotChain::addPivot() {
+    if (_numberOfPivots == _capacity) {
+        grow();
+    }
+    
+    _numberOfPivots++;
+    return getLast();
+}
+
+void PivotChain::removeFirst() {
+    if (_numberOfPivots > 0) {
+        _first = (_first + 1) & (_capacity - 1);
+        _numberOfPivots--;
+    }
+}
+
+void PivotChain::removeLast() {
+    if (_numberOfPivots > 0) {
+        _numberOfPivots--;
+    }
+}
+
+void PivotChain::clear() {
+    _first = 0;
+    _numberOfPivots = 0;
+}
+
+void PivotChain::setNumberOfPivots(int numberOfPivots) {
+    _numberOfPivots = min(numberOfPivots, _capacity);
+}
+
+void PivotChain::swap(PivotChain *chain) {
+    bool inlineHere = _pivots == _inlinePivots;
+    bool inlineThere = chain->_pivots == chain->_inlinePivots;
+    
+    if (inlineHere || inlineThere) {
+        for (int i = 0; i < INLINE_PIVOTS; i++) {
+            Pivot pivot = _inlinePivots[i];
+            _inlinePivots[i] = chain->_inlinePivots[i];
+            chain->_inlinePivots[i] = pivot;
+        }
+    }
+    
+    Pivot *pivots = _pivots;
+    _pivots = inlineThere ? _inlinePivots : chain->_pivots;
+    chain->_pivots = inlineHere ? chain->_inlinePivots : pivots;
+    
+    int capacity = _capacity;
+    _capacity = chain->_capacity;
+    chain->_capacity = capacity;
+    
+    int first = _first;
+    _first = chain->_first;
+    chain->_first = first;
+    
+    int numberOfPivots = _numberOfPivots;
+    _numberOfPivots = chain->_numberOfPivots;
+    chain->_numberOfPivots = numberOfPivots;
+}
+
+void PivotChain::grow() {
+    Pivot *newPivots = new Pivot[_capacity * 2];
+    
+    // whole pivots, platform and all, unwrapped so the first is at the start again
+    for (int i = 0; i < _numberOfPivots; i++) {
+        newPivots[i] = *getPivot(i);
+    }
+    
+    if (_pivots != _inlinePivots) {
+        delete[] _pivots;
+    }
+    
+    _pivots = newPivots;
+    _capacity *= 2;
+    _first = 0;
+}
+
 Rope::Rope(Player *p, int gX, int gY) {
     _player = p;
     
+    reset(gX, gY);
+}
+
+Rope::~Rope() {
+}
+
+void Rope::reset(int gX, int gY) {
     _grappleX = gX;
     _grappleY = gY;
     
+    _pivots.clear();
+    
     _ropeLength = getCurrentLength();
     _angle = getCurrentAngle();
     _stretch = 0;
-    
-    // pivots
-    _pivots = new Pivot[10];
-    _numberOfPivots = 0;
-    _pivotsCapacity = 10;
-}
-
-Rope::~Rope() {
-    delete[] _pivots;
 }
 
 double Rope::getAccelerationX() {
@@ -678,7 +753,7 @@ double Rope::getAccelerationY() {
 }
 
 double Rope::getCurrentLength() {
-    if (_numberOfPivots == 0) {
+    if (_pivots.getNumberOfPivots() == 0) {
         double diffX = _grappleX - (_player->getX() + _player->getWidth() / 2);
         double diffY = _grappleY - (_player->getY() + _player->getHeight() / 2);
         
@@ -686,23 +761,23 @@ double Rope::getCurrentLength() {
     }
     
     double sum = 0;
-    double diffX = _grappleX - _pivots[0].getX();
-    double diffY = _grappleY - _pivots[0].getY();
+    double diffX = _grappleX - _pivots.getPivot(0)->getX();
+    double diffY = _grappleY - _pivots.getPivot(0)->getY();
     sum += sqrt(pow(diffX, 2) + pow(diffY, 2));
     
-    for (int i = 1; i < _numberOfPivots; i++) {
-        diffX = _pivots[i - 1].getX() - _pivots[i].getX();
-        diffY = _pivots[i - 1].getY() - _pivots[i].getY();
+    for (int i = 1; i < _pivots.getNumberOfPivots(); i++) {
+        diffX = _pivots.getPivot(i - 1)->getX() - _pivots.getPivot(i)->getX();
+        diffY = _pivots.getPivot(i - 1)->getY() - _pivots.getPivot(i)->getY();
         sum += sqrt(pow(diffX, 2) + pow(diffY, 2));
     }
-        
-    diffX = _pivots[_numberOfPivots - 1].getX() - (_player->getX() + _player->getWidth() / 2);
-    diffY = _pivots[_numberOfPivots - 1].getY() - (_player->getY() + _player->getHeight() / 2);
-    sum += sqrt(pow(diffX, 2) + pow(diffY, 2));
     
+    diffX = _pivots.getLast()->getX() - (_player->getX() + _player->getWidth() / 2);
+    diffY = _pivots.getLast()->getY() - (_player->getY() + _player->getHeight() / 2);
+    sum += sqrt(pow(diffX, 2) + pow(diffY, 2));
+
 //    printf("Current Rope Length: %f\n", sum);
 //    printf("Real Rope Length: %f\n", _ropeLength);
-//    printf("Number of Pivots: %d\n", _numberOfPivots);
+//    printf("Number of Pivots: %d\n", _pivots.getNumberOfPivots());
     return sum;
 }
 
@@ -710,32 +785,37 @@ double Rope::getCurrentAngle() {
     double diffX;
     double diffY;
     
-    if (_numberOfPivots > 0) {
-        diffX = _pivots[_numberOfPivots - 1].getX() - (_player->getX() + _player->getWidth() / 2);
-        diffY = _pivots[_numberOfPivots - 1].getY() - (_player->getY() + _player->getHeight() / 2);
+    if (_pivots.getNumberOfPivots() > 0) {
+        diffX = _pivots.getLast()->getX() - (_player->getX() + _player->getWidth() / 2);
+        diffY = _pivots.getLast()->getY() - (_player->getY() + _player->getHeight() / 2);
     } else {
         diffX = _grappleX - (_player->getX() + _player->getWidth() / 2);
         diffY = _grappleY - (_player->getY() + _player->getHeight() / 2);
     }
-        
+    
     return atan2(diffY, diffX);
 }
 
 int Rope::collideCorners(Level *level) {
+    requireRopeArea(_player, level);
+    
     double diffX;
     double diffY;
     
-    CollisionReportContainer container;
+    _collisions.clear();
+    
+    COUNT_STAT(PLATFORM_SCANS, 1);
+    COUNT_STAT(PLATFORMS_TESTED, level->getNumberOfPlatforms());
     for (int i = 0; i < level->getNumberOfPlatforms(); i++) {
         double x1, y1, x2, y2;
         double rx, ry, rw, rh;
         
-        if (_numberOfPivots == 0) {
+        if (_pivots.getNumberOfPivots() == 0) {
             x1 = _grappleX;
             y1 = _grappleY;
         } else {
-            x1 = _pivots[_numberOfPivots - 1].getX();
-            y1 = _pivots[_numberOfPivots - 1].getY();
+            x1 = _pivots.getLast()->getX();
+            y1 = _pivots.getLast()->getY();
         }
         
         x2 = _player->getX() + _player->getWidth() / 2;
@@ -746,7 +826,8 @@ int Rope::collideCorners(Level *level) {
         rw = level->getPlatform(i)->getWidth();
         rh = level->getPlatform(i)->getHeight();
         
-        CollisionReportContainer *collisions = getLineRectangleCollision(x1, y1, x2, y2, rx, ry, rw, rh);
+        CollisionReportContainer *collisions = &_platformCollisions;
+        getLineRectangleCollision(x1, y1, x2, y2, rx, ry, rw, rh, collisions);
         
         if (collisions->getNumberOfReports() > 0) {
             double newDistance, oldDistance;
@@ -759,31 +840,29 @@ int Rope::collideCorners(Level *level) {
             diffY = level->getPlatform(i)->getY() - _player->getY();
             newDistance = sqrt(pow(diffX, 2) + pow(diffY, 2));
             
-            if (container.getNumberOfReports() > 0) {
-                diffX = container.getReport(0)->getPlatform()->getX() - _player->getX();
-                diffY = container.getReport(0)->getPlatform()->getY() - _player->getY();
+            if (_collisions.getNumberOfReports() > 0) {
+                diffX = _collisions.getReport(0)->getPlatform()->getX() - _player->getX();
+                diffY = _collisions.getReport(0)->getPlatform()->getY() - _player->getY();
                 oldDistance = sqrt(pow(diffX, 2) + pow(diffY, 2));
                 
                 if (newDistance < oldDistance) {
-                    container.clear();
+                    _collisions.clear();
                     
                     for (int j = 0; j < collisions->getNumberOfReports(); j++) {
-                        container.addReport(collisions->getReport(j)->getIntersectionX(), collisions->getReport(j)->getIntersectionY());
-                        container.getReport(j)->setPlatform(collisions->getReport(j)->getPlatform());
+                        _collisions.addReport(collisions->getReport(j)->getIntersectionX(), collisions->getReport(j)->getIntersectionY());
+                        _collisions.getReport(j)->setPlatform(collisions->getReport(j)->getPlatform());
                     }
                 }
             } else {
                 for (int j = 0; j < collisions->getNumberOfReports(); j++) {
-                    container.addReport(collisions->getReport(j)->getIntersectionX(), collisions->getReport(j)->getIntersectionY());
-                    container.getReport(j)->setPlatform(collisions->getReport(j)->getPlatform());
+                    _collisions.addReport(collisions->getReport(j)->getIntersectionX(), collisions->getReport(j)->getIntersectionY());
+                    _collisions.getReport(j)->setPlatform(collisions->getReport(j)->getPlatform());
                 }
             }
         }
-        
-        delete collisions;
     }
     
-    if (container.getNumberOfReports()) {
+    if (_collisions.getNumberOfReports()) {
         bool left = false;
         bool right = false;
         bool up = false;
@@ -799,15 +878,15 @@ int Rope::collideCorners(Level *level) {
         bool collidingUp = false;
         bool collidingDown = false;
         
-        if (_player->getX() + _player->getWidth() / 2 < container.getReport(0)->getPlatform()->getX()) {
+        if (_player->getX() + _player->getWidth() / 2 < _collisions.getReport(0)->getPlatform()->getX()) {
             left = true;
-        } else if (_player->getX() + _player->getWidth() / 2 > container.getReport(0)->getPlatform()->getX() + container.getReport(0)->getPlatform()->getWidth()) {
+        } else if (_player->getX() + _player->getWidth() / 2 > _collisions.getReport(0)->getPlatform()->getX() + _collisions.getReport(0)->getPlatform()->getWidth()) {
             right = true;
         }
         
-        if (_player->getY() + _player->getHeight() / 2 < container.getReport(0)->getPlatform()->getY()) {
+        if (_player->getY() + _player->getHeight() / 2 < _collisions.getReport(0)->getPlatform()->getY()) {
             up = true;
-        } else if (_player->getY() + _player->getHeight() / 2 > container.getReport(0)->getPlatform()->getY() + container.getReport(0)->getPlatform()->getHeight()) {
+        } else if (_player->getY() + _player->getHeight() / 2 > _collisions.getReport(0)->getPlatform()->getY() + _collisions.getReport(0)->getPlatform()->getHeight()) {
             down = true;
         }
         
@@ -823,53 +902,53 @@ int Rope::collideCorners(Level *level) {
             movingDown = true;
         }
         
-        for (int i = 0; i < container.getNumberOfReports(); i++) {
-//            printf("pX: %d, pY: %d, pW: %d, pH: %d\n", container.getReport(i)->getPlatform()->getX(), container.getReport(i)->getPlatform()->getY(), container.getReport(i)->getPlatform()->getWidth(), container.getReport(i)->getPlatform()->getHeight());
-//            printf("iX: %f, iY: %f\n", container.getReport(i)->getIntersectionX(), container.getReport(i)->getIntersectionY());
+        for (int i = 0; i < _collisions.getNumberOfReports(); i++) {
+//            printf("pX: %d, pY: %d, pW: %d, pH: %d\n", _collisions.getReport(i)->getPlatform()->getX(), _collisions.getReport(i)->getPlatform()->getY(), _collisions.getReport(i)->getPlatform()->getWidth(), _collisions.getReport(i)->getPlatform()->getHeight());
+//            printf("iX: %f, iY: %f\n", _collisions.getReport(i)->getIntersectionX(), _collisions.getReport(i)->getIntersectionY());
             
-            if (container.getReport(i)->getIntersectionX() == container.getReport(i)->getPlatform()->getX()) {
+            if (_collisions.getReport(i)->getIntersectionX() == _collisions.getReport(i)->getPlatform()->getX()) {
                 collidingLeft = true;
-            } else if (container.getReport(i)->getIntersectionX() == container.getReport(i)->getPlatform()->getX() + container.getReport(i)->getPlatform()->getWidth()) {
+            } else if (_collisions.getReport(i)->getIntersectionX() == _collisions.getReport(i)->getPlatform()->getX() + _collisions.getReport(i)->getPlatform()->getWidth()) {
                 collidingRight = true;
             }
             
-            if (container.getReport(i)->getIntersectionY() == container.getReport(i)->getPlatform()->getY()) {
+            if (_collisions.getReport(i)->getIntersectionY() == _collisions.getReport(i)->getPlatform()->getY()) {
                 collidingUp = true;
-            } else if (container.getReport(i)->getIntersectionY() == container.getReport(i)->getPlatform()->getY() + container.getReport(i)->getPlatform()->getHeight()) {
+            } else if (_collisions.getReport(i)->getIntersectionY() == _collisions.getReport(i)->getPlatform()->getY() + _collisions.getReport(i)->getPlatform()->getHeight()) {
                 collidingDown = true;
             }
         }
-        
+
 //        printf("l: %d, r: %d, u: %d, d: %d, mL: %d, mR: %d, mU: %d, mD: %d, cL: %d, cR: %d, cU: %d, cD: %d\n", left, right, up, down, movingLeft, movingRight, movingUp, movingDown, collidingLeft, collidingRight, collidingUp, collidingDown);
         
         if ((collidingLeft && collidingUp) && (up || left) && (movingRight || movingDown)) {
 //            printf("TOP LEFT\n");
-            addPivot(container.getReport(0)->getPlatform(), TOP_LEFT);
+            addPivot(_collisions.getReport(0)->getPlatform(), TOP_LEFT);
         } else if ((collidingRight && collidingUp) && (up || right) && (movingLeft || movingDown)) {
 //            printf("TOP RIGHT\n");
-            addPivot(container.getReport(0)->getPlatform(), TOP_RIGHT);
+            addPivot(_collisions.getReport(0)->getPlatform(), TOP_RIGHT);
         } else if ((collidingLeft && collidingDown) && (down || left) && (movingRight || movingUp)) {
 //            printf("BOTTOM LEFT\n");
-            addPivot(container.getReport(0)->getPlatform(), BOTTOM_LEFT);
+            addPivot(_collisions.getReport(0)->getPlatform(), BOTTOM_LEFT);
         } else if ((collidingRight && collidingDown) && (down || right) && (movingLeft || movingUp)) {
 //            printf("BOTTOM RIGHT\n");
-            addPivot(container.getReport(0)->getPlatform(), BOTTOM_RIGHT);
+            addPivot(_collisions.getReport(0)->getPlatform(), BOTTOM_RIGHT);
         } else if ((collidingUp && collidingDown)) {
             if (down) {
                 if (movingRight) {
-                    addPivot(container.getReport(0)->getPlatform(), TOP_LEFT);
-                    addPivot(container.getReport(0)->getPlatform(), BOTTOM_LEFT);
+                    addPivot(_collisions.getReport(0)->getPlatform(), TOP_LEFT);
+                    addPivot(_collisions.getReport(0)->getPlatform(), BOTTOM_LEFT);
                 } else if (movingLeft) {
-                    addPivot(container.getReport(0)->getPlatform(), TOP_RIGHT);
-                    addPivot(container.getReport(0)->getPlatform(), BOTTOM_RIGHT);
+                    addPivot(_collisions.getReport(0)->getPlatform(), TOP_RIGHT);
+                    addPivot(_collisions.getReport(0)->getPlatform(), BOTTOM_RIGHT);
                 }
             } else if (up) {
                 if (movingRight) {
-                    addPivot(container.getReport(0)->getPlatform(), BOTTOM_LEFT);
-                    addPivot(container.getReport(0)->getPlatform(), TOP_LEFT);
+                    addPivot(_collisions.getReport(0)->getPlatform(), BOTTOM_LEFT);
+                    addPivot(_collisions.getReport(0)->getPlatform(), TOP_LEFT);
                 } else if (movingLeft) {
-                    addPivot(container.getReport(0)->getPlatform(), BOTTOM_RIGHT);
-                    addPivot(container.getReport(0)->getPlatform(), TOP_RIGHT);
+                    addPivot(_collisions.getReport(0)->getPlatform(), BOTTOM_RIGHT);
+                    addPivot(_collisions.getReport(0)->getPlatform(), TOP_RIGHT);
                 }
             }
         }
@@ -892,101 +971,103 @@ void Rope::decreaseSlack() {
     }
 }
 
-Pivot *Rope::getPivots() {
-    return _pivots;
+PivotChain *Rope::getPivots() {
+    return &_pivots;
 }
 
 void Rope::setNumberOfPivots(int x) {
-    _numberOfPivots = x;
+    _pivots.setNumberOfPivots(x);
+}
+
+void Rope::takePivots(PivotChain *pivots) {
+    _pivots.swap(pivots);
 }
 
 void Rope::addPivot(Platform *platform, int corner) {
+    COUNT_STAT(PIVOTS_ADDED, 1);
+    
+    Pivot pivot;
+    pivot.setPivotPlatform(platform);
+    
     if (corner == TOP_LEFT) {
-        _pivots[_numberOfPivots].setX(platform->getX() - 2);
-        _pivots[_numberOfPivots].setY(platform->getY() - 2);
-        _pivots[_numberOfPivots].setDrawX(platform->getX() - 1);
-        _pivots[_numberOfPivots].setDrawY(platform->getY() - 1);
+        pivot.setX(platform->getX() - 2);
+        pivot.setY(platform->getY() - 2);
+        pivot.setDrawX(platform->getX() - 1);
+        pivot.setDrawY(platform->getY() - 1);
     } else if (corner == TOP_RIGHT) {
-        _pivots[_numberOfPivots].setX(platform->getX() + platform->getWidth() + 1);
-        _pivots[_numberOfPivots].setY(platform->getY() - 2);
-        _pivots[_numberOfPivots].setDrawX(platform->getX() + platform->getWidth());
-        _pivots[_numberOfPivots].setDrawY(platform->getY() - 1);
+        pivot.setX(platform->getX() + platform->getWidth() + 1);
+        pivot.setY(platform->getY() - 2);
+        pivot.setDrawX(platform->getX() + platform->getWidth());
+        pivot.setDrawY(platform->getY() - 1);
     } else if (corner == BOTTOM_LEFT) {
-        _pivots[_numberOfPivots].setX(platform->getX() - 2);
-        _pivots[_numberOfPivots].setY(platform->getY() + platform->getHeight() + 1);
-        _pivots[_numberOfPivots].setDrawX(platform->getX() - 1);
-        _pivots[_numberOfPivots].setDrawY(platform->getY() + platform->getHeight());
+        pivot.setX(platform->getX() - 2);
+        pivot.setY(platform->getY() + platform->getHeight() + 1);
+        pivot.setDrawX(platform->getX() - 1);
+        pivot.setDrawY(platform->getY() + platform->getHeight());
     } else if (corner == BOTTOM_RIGHT) {
-        _pivots[_numberOfPivots].setX(platform->getX() + platform->getWidth() + 1);
-        _pivots[_numberOfPivots].setY(platform->getY() + platform->getHeight() + 1);
-        _pivots[_numberOfPivots].setDrawX(platform->getX() + platform->getWidth());
-        _pivots[_numberOfPivots].setDrawY(platform->getY() + platform->getHeight());
+        pivot.setX(platform->getX() + platform->getWidth() + 1);
+        pivot.setY(platform->getY() + platform->getHeight() + 1);
+        pivot.setDrawX(platform->getX() + platform->getWidth());
+        pivot.setDrawY(platform->getY() + platform->getHeight());
     }
     
     double diffX;
     double diffY;
-    if (_numberOfPivots > 0) {
-        diffX = _pivots[_numberOfPivots - 1].getX() - _pivots[_numberOfPivots].getX();
-        diffY = _pivots[_numberOfPivots - 1].getY() - _pivots[_numberOfPivots].getY();
+    if (_pivots.getNumberOfPivots() > 0) {
+        diffX = _pivots.getLast()->getX() - pivot.getX();
+        diffY = _pivots.getLast()->getY() - pivot.getY();
     } else {
-        diffX = _grappleX - _pivots[_numberOfPivots].getX();
-        diffY = _grappleY - _pivots[_numberOfPivots].getY();
+        diffX = _grappleX - pivot.getX();
+        diffY = _grappleY - pivot.getY();
     }
     
-    _pivots[_numberOfPivots].setAttachAngle(atan2(diffY, diffX));
+    pivot.setAttachAngle(atan2(diffY, diffX));
     
-    _numberOfPivots++;
-    if (_numberOfPivots >= _pivotsCapacity) {
-        Pivot *newPivots = new Pivot[_pivotsCapacity * 2];
-        _pivotsCapacity *= 2;
-        
-        for (int i = 0; i < _numberOfPivots; i++) {
-            newPivots[i].setX(_pivots[i].getX());
-            newPivots[i].setY(_pivots[i].getY());
-            newPivots[i].setDrawX(_pivots[i].getDrawX());
-            newPivots[i].setDrawY(_pivots[i].getDrawY());
-            newPivots[i].setAttachAngle(_pivots[i].getAttachAngle());
-        }
-        
-        delete[] _pivots;
-        _pivots = newPivots;
-    }
+    *_pivots.addPivot() = pivot;
 }
 
 bool Rope::update(Level *level) {
+    PROFILE_ZONE("Rope::update");
+    
     _previousAngle = _angle;
     _angle = getCurrentAngle();
     _stretch = getCurrentLength() - _ropeLength;
     
     // destroy the current pivot if and when it's passed again
-    if (_numberOfPivots) {
-        if (_pivots[_numberOfPivots - 1].getAttachAngle() > M_PI_2 &&  // top right sector
-            ((_previousAngle > M_PI_2 && _previousAngle < _pivots[_numberOfPivots - 1].getAttachAngle() && getCurrentAngle() < -M_PI_2) ||
-             (getCurrentAngle() > M_PI_2 && getCurrentAngle() < _pivots[_numberOfPivots - 1].getAttachAngle() && _previousAngle < -M_PI_2))) {
-            _numberOfPivots--;
-        } else if (_pivots[_numberOfPivots - 1].getAttachAngle() < -M_PI_2 &&  // bottom right sector
-                   ((_previousAngle < -M_PI_2 && _previousAngle > _pivots[_numberOfPivots - 1].getAttachAngle() && getCurrentAngle() > M_PI_2) ||
-                    (getCurrentAngle() < -M_PI_2 && getCurrentAngle() > _pivots[_numberOfPivots - 1].getAttachAngle() && _previousAngle > M_PI_2))) {
-            _numberOfPivots--;
-        } else if (((_pivots[_numberOfPivots - 1].getAttachAngle() < getCurrentAngle() && _pivots[_numberOfPivots - 1].getAttachAngle() > _previousAngle) ||
-                    (_pivots[_numberOfPivots - 1].getAttachAngle() > getCurrentAngle() && _pivots[_numberOfPivots - 1].getAttachAngle() < _previousAngle)) &&
+    if (_pivots.getNumberOfPivots()) {
+        if (_pivots.getLast()->getAttachAngle() > M_PI_2 &&  // top right sector
+            ((_previousAngle > M_PI_2 && _previousAngle < _pivots.getLast()->getAttachAngle() && getCurrentAngle() < -M_PI_2) ||
+             (getCurrentAngle() > M_PI_2 && getCurrentAngle() < _pivots.getLast()->getAttachAngle() && _previousAngle < -M_PI_2))) {
+            _pivots.removeLast();
+            COUNT_STAT(PIVOTS_REMOVED, 1);
+        } else if (_pivots.getLast()->getAttachAngle() < -M_PI_2 &&  // bottom right sector
+                   ((_previousAngle < -M_PI_2 && _previousAngle > _pivots.getLast()->getAttachAngle() && getCurrentAngle() > M_PI_2) ||
+                    (getCurrentAngle() < -M_PI_2 && getCurrentAngle() > _pivots.getLast()->getAttachAngle() && _previousAngle > M_PI_2))) {
+            _pivots.removeLast();
+            COUNT_STAT(PIVOTS_REMOVED, 1);
+        } else if (((_pivots.getLast()->getAttachAngle() < getCurrentAngle() && _pivots.getLast()->getAttachAngle() > _previousAngle) ||
+                    (_pivots.getLast()->getAttachAngle() > getCurrentAngle() && _pivots.getLast()->getAttachAngle() < _previousAngle)) &&
                    !((getCurrentAngle() > M_PI_2 && _previousAngle < -M_PI_2) || (_previousAngle > M_PI_2 && getCurrentAngle() < -M_PI_2))) {
-            _numberOfPivots--;
+            _pivots.removeLast();
+            COUNT_STAT(PIVOTS_REMOVED, 1);
         }
         
-        if (_numberOfPivots) {
-            if (_pivots[_numberOfPivots - 1].getAttachAngle() > M_PI_2 &&  // top right sector
-                ((_previousAngle > M_PI_2 && _previousAngle < _pivots[_numberOfPivots - 1].getAttachAngle() && getCurrentAngle() < -M_PI_2) ||
-                 (getCurrentAngle() > M_PI_2 && getCurrentAngle() < _pivots[_numberOfPivots - 1].getAttachAngle() && _previousAngle < -M_PI_2))) {
-                _numberOfPivots--;
-            } else if (_pivots[_numberOfPivots - 1].getAttachAngle() < -M_PI_2 &&  // bottom right sector
-                       ((_previousAngle < -M_PI_2 && _previousAngle > _pivots[_numberOfPivots - 1].getAttachAngle() && getCurrentAngle() > M_PI_2) ||
-                        (getCurrentAngle() < -M_PI_2 && getCurrentAngle() > _pivots[_numberOfPivots - 1].getAttachAngle() && _previousAngle > M_PI_2))) {
-                _numberOfPivots--;
-            } else if (((_pivots[_numberOfPivots - 1].getAttachAngle() < getCurrentAngle() && _pivots[_numberOfPivots - 1].getAttachAngle() > _previousAngle) ||
-                        (_pivots[_numberOfPivots - 1].getAttachAngle() > getCurrentAngle() && _pivots[_numberOfPivots - 1].getAttachAngle() < _previousAngle)) &&
+        if (_pivots.getNumberOfPivots()) {
+            if (_pivots.getLast()->getAttachAngle() > M_PI_2 &&  // top right sector
+                ((_previousAngle > M_PI_2 && _previousAngle < _pivots.getLast()->getAttachAngle() && getCurrentAngle() < -M_PI_2) ||
+                 (getCurrentAngle() > M_PI_2 && getCurrentAngle() < _pivots.getLast()->getAttachAngle() && _previousAngle < -M_PI_2))) {
+                _pivots.removeLast();
+                COUNT_STAT(PIVOTS_REMOVED, 1);
+            } else if (_pivots.getLast()->getAttachAngle() < -M_PI_2 &&  // bottom right sector
+                       ((_previousAngle < -M_PI_2 && _previousAngle > _pivots.getLast()->getAttachAngle() && getCurrentAngle() > M_PI_2) ||
+                        (getCurrentAngle() < -M_PI_2 && getCurrentAngle() > _pivots.getLast()->getAttachAngle() && _previousAngle > M_PI_2))) {
+                _pivots.removeLast();
+                COUNT_STAT(PIVOTS_REMOVED, 1);
+            } else if (((_pivots.getLast()->getAttachAngle() < getCurrentAngle() && _pivots.getLast()->getAttachAngle() > _previousAngle) ||
+                        (_pivots.getLast()->getAttachAngle() > getCurrentAngle() && _pivots.getLast()->getAttachAngle() < _previousAngle)) &&
                        !((getCurrentAngle() > M_PI_2 && _previousAngle < -M_PI_2) || (_previousAngle > M_PI_2 && getCurrentAngle() < -M_PI_2))) {
-                _numberOfPivots--;
+                _pivots.removeLast();
+                COUNT_STAT(PIVOTS_REMOVED, 1);
             }
         }
     }
@@ -995,64 +1076,46 @@ bool Rope::update(Level *level) {
     return true;
 }
 
-void Rope::draw(SDL_Renderer *renderer) {
-    draw(renderer, 0, 0);
+void Rope::snapshot(GrappleSnapshot *grapple) {
+    grapple->setHook(_grappleX, _grappleY);
+    for (int i = 0; i < _pivots.getNumberOfPivots(); i++) {
+        grapple->addPivot(_pivots.getPivot(i)->getDrawX(), _pivots.getPivot(i)->getDrawY());
+    }
 }
 
-void Rope::draw(SDL_Renderer *renderer, double cameraX, double cameraY) {
-    SDL_SetRenderDrawColor(renderer, 0x00, 0xFF, 0x00, 0xFF);
-    
-    if (_numberOfPivots > 0) {
-        SDL_RenderDrawLine(renderer, _grappleX - cameraX, _grappleY - cameraY, _pivots[0].getDrawX() - cameraX, _pivots[0].getDrawY() - cameraY);
-        for (int i = 1; i < _numberOfPivots; i++) {
-            SDL_RenderDrawLine(renderer, _pivots[i - 1].getDrawX() - cameraX, _pivots[i - 1].getDrawY() - cameraY, _pivots[i].getDrawX() - cameraX, _pivots[i].getDrawY() - cameraY);
-        }
-        SDL_RenderDrawLine(renderer, _pivots[_numberOfPivots - 1].getDrawX() - cameraX, _pivots[_numberOfPivots - 1].getDrawY() - cameraY, _player->getX() + _player->getWidth() / 2 - cameraX, _player->getY() + _player->getHeight() / 2 - cameraY);
-    } else {
-        SDL_RenderDrawLine(renderer, static_cast<int>(_player->getX() + _player->getWidth() / 2 - cameraX), static_cast<int>(_player->getY() + _player->getHeight() / 2 - cameraY), _grappleX - cameraX, _grappleY - cameraY);
-    }
-    
-    // square where the hook is
-    SDL_SetRenderDrawColor(renderer, 0x00, 0x00, 0xFF, 0xFF);
-    SDL_Rect grappleRect = { _grappleX - static_cast<int>(cameraX) - GRAPPLE_RECT_HALF_WIDTH, _grappleY - static_cast<int>(cameraY) - GRAPPLE_RECT_HALF_WIDTH, GRAPPLE_RECT_HALF_WIDTH * 2, GRAPPLE_RECT_HALF_WIDTH * 2 };
-    SDL_RenderFillRect(renderer, &grappleRect);
+void Rope::reportMemory(MemoryReport *report) {
+    report->add(ROPE_PIVOTS, _pivots.getNumberOfPivots() * sizeof(Pivot), _pivots.getCapacity() * sizeof(Pivot));
 }
 
 // collision code from https://www.jeffreythompson.org/collision-detection/line-rect.php (modified)
-CollisionReportContainer *getLineRectangleCollision(float x1, float y1, float x2, float y2, float rx, float ry, float rw, float rh) {
-    CollisionReportContainer *newContainer = new CollisionReportContainer();
+void getLineRectangleCollision(float x1, float y1, float x2, float y2, float rx, float ry, float rw, float rh, CollisionReportContainer *collisions) {
+    COUNT_STAT(LINE_RECT_TESTS, 1);
+    
+    collisions->clear();
     
     // check if the line has hit any of the rectangle's sides
     // uses the Line/Line function below
-    CollisionReport *leftCollisionReport = getLineCollision(x1,y1,x2,y2, rx,ry,rx, ry+rh);
-    if (leftCollisionReport) {
-        newContainer->addReport(leftCollisionReport->getIntersectionX(), leftCollisionReport->getIntersectionY());
-        delete leftCollisionReport;
+    CollisionReport collision;
+    
+    if (getLineCollision(x1,y1,x2,y2, rx,ry,rx, ry+rh, &collision)) {
+        collisions->addReport(collision.getIntersectionX(), collision.getIntersectionY());
     }
     
-    CollisionReport *rightCollisionReport = getLineCollision(x1,y1,x2,y2, rx+rw,ry, rx+rw,ry+rh);
-    if (rightCollisionReport) {
-        newContainer->addReport(rightCollisionReport->getIntersectionX(), rightCollisionReport->getIntersectionY());
-        delete rightCollisionReport;
+    if (getLineCollision(x1,y1,x2,y2, rx+rw,ry, rx+rw,ry+rh, &collision)) {
+        collisions->addReport(collision.getIntersectionX(), collision.getIntersectionY());
     }
     
-    CollisionReport *topCollisionReport = getLineCollision(x1,y1,x2,y2, rx,ry, rx+rw,ry);
-    if (topCollisionReport) {
-        newContainer->addReport(topCollisionReport->getIntersectionX(), topCollisionReport->getIntersectionY());
-        delete topCollisionReport;
+    if (getLineCollision(x1,y1,x2,y2, rx,ry, rx+rw,ry, &collision)) {
+        collisions->addReport(collision.getIntersectionX(), collision.getIntersectionY());
     }
     
-    CollisionReport *bottomCollisionReport = getLineCollision(x1,y1,x2,y2, rx,ry+rh, rx+rw,ry+rh);
-    if (bottomCollisionReport) {
-        newContainer->addReport(bottomCollisionReport->getIntersectionX(), bottomCollisionReport->getIntersectionY());
-        delete bottomCollisionReport;
+    if (getLineCollision(x1,y1,x2,y2, rx,ry+rh, rx+rw,ry+rh, &collision)) {
+        collisions->addReport(collision.getIntersectionX(), collision.getIntersectionY());
     }
-
-    return newContainer;
 }
 
 
-CollisionReport *getLineCollision(float x1, float y1, float x2, float y2, float x3, float y3, float x4, float y4) {
+bool getLineCollision(float x1, float y1, float x2, float y2, float x3, float y3, float x4, float y4, CollisionReport *collision) {
     // calculate the direction of the lines
     float uA = ((x4-x3)*(y1-y3) - (y4-y3)*(x1-x3)) / ((y4-y3)*(x2-x1) - (x4-x3)*(y2-y1));
     float uB = ((x2-x1)*(y1-y3) - (y2-y1)*(x1-x3)) / ((y4-y3)*(x2-x1) - (x4-x3)*(y2-y1));
@@ -1062,17 +1125,17 @@ CollisionReport *getLineCollision(float x1, float y1, float x2, float y2, float
         float intersectionX = x1 + (uA * (x2-x1));
         float intersectionY = y1 + (uA * (y2-y1));
         
-        CollisionReport *report = new CollisionReport();
-        report->setIntersectionX(intersectionX);
-        report->setIntersectionY(intersectionY);
+        collision->setIntersectionX(intersectionX);
+        collision->setIntersectionY(intersectionY);
         
-        return report;
+        return true;
     }
     
-    return NULL;
+    return false;
 }
 
 bool checkLineRectCollision(float x1, float y1, float x2, float y2, float rx, float ry, float rw, float rh) {
+    COUNT_STAT(LINE_RECT_TESTS, 1);
 
   // check if the line has hit any of the rectangle's sides
   // uses the Line/Line function below
@@ -1098,6 +1161,11 @@ bool checkLineCollision(float x1, float y1, float x2, float y2, float x3, float
   if (uA >= 0 && uA <= 1 && uB >= 0 && uB <= 1) {
     return true;
   }
-    
+  
   return false;
 }
+
+void requireRopeArea(Player *player, Level *level) {
+    int reach = MAX_ROPE_LENGTH + PLATFORM_WIDTH;
+    level->requireArea(player->getX() - reach, player->getY() - reach, player->getWidth() + reach * 2, player->getHeight() + reach * 2);
+}
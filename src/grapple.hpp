@@ -3,6 +3,7 @@
 
 #include "player.hpp"
 #include "level.hpp"
+#include "snapshot.hpp"
 
 enum Corners {
     TOP_LEFT,
@@ -21,6 +22,9 @@ const double RETRACT_SPEED = 12;
 
 const int GRAPPLE_RECT_HALF_WIDTH = 5;
 
+// pivots a chain holds without going to the heap. a power of two, like every capacity after it
+const int INLINE_PIVOTS = 16;
+
 class Player;
 
 class CollisionReport {
@@ -62,6 +66,13 @@ private:
     int _reportsCapacity;
 };
 
+// from the internet. see definitions at the bottom of grapple.cpp (modified).
+// the reports go into containers and reports the caller keeps, so testing doesn't allocate
+void getLineRectangleCollision(float x1, float y1, float x2, float y2, float rx, float ry, float rw, float rh, CollisionReportContainer *collisions);
+bool getLineCollision(float x1, float y1, float x2, float y2, float x3, float y3, float x4, float y4, CollisionReport *collision);
+bool checkLineRectCollision(float x1, float y1, float x2, float y2, float rx, float ry, float rw, float rh);
+bool checkLineCollision(float x1, float y1, float x2, float y2, float x3, float y3, float x4, float y4);
+
 class Pivot {
 public:
     int getX();
@@ -92,25 +103,74 @@ private:
     double _attachAngle;
 };
 
+// the corners a rope or seeker is wrapped around, from the hook end to the player's. the first
+// INLINE_PIVOTS are stored in the chain itself and only longer chains move to the heap, doubling.
+// it's a ring, so dropping the first pivot doesn't shift the rest
+class PivotChain {
+public:
+    PivotChain();
+    ~PivotChain();
+    
+    int getNumberOfPivots();
+    int getCapacity();
+    
+    // 0 is at the hook end
+    Pivot *getPivot(int i);
+    Pivot *getLast();
+    
+    // a new pivot at the player's end, for the caller to fill in
+    Pivot *addPivot();
+    
+    void removeFirst();
+    void removeLast();
+    void clear();
+    
+    // to put back pivots taken off the player's end, which stay where they were until they're overwritten
+    void setNumberOfPivots(int numberOfPivots);
+    
+    // trades pivots with chain. heap storage changes hands without being copied; only the inline
+    // buffers are, so it takes the same time however long either chain is
+    void swap(PivotChain *chain);
+    
+private:
+    void grow();
+    
+    Pivot _inlinePivots[INLINE_PIVOTS];
+    
+    // _inlinePivots, or an array on the heap once the chain has outgrown them
+    Pivot *_pivots;
+    int _capacity;
+    
+    int _first;
+    int _numberOfPivots;
+};
+
+// the player keeps one of these and one rope for good, and resets them for each grapple,
+// so the pivot arrays keep whatever capacity they've grown to
 class GrappleSeeker {
 public:
     GrappleSeeker(Player *player, double angle);
     ~GrappleSeeker();
     
+    // fired again from the player at angle, with no pivots
+    void reset(double angle);
+    
     void addVelocityX(double x);
     void addVelocityY(double y);
     
     double getCurrentLength();
+    int getNumberOfPivots();
     
-    CollisionReport *collide(Platform *platform);
+    // the collision with the platform closest to (or, retracting, furthest from) the player, if there is one
+    bool collide(Platform *platform, CollisionReport *closestCollision);
     bool seek(Level *level);
     
     void removeFirstPivot();
     
     int wrapCorners(Level *level);
     
-    void draw(SDL_Renderer *renderer);
-    void draw(SDL_Renderer *renderer, int cameraX, int cameraY);
+    void snapshot(GrappleSnapshot *grapple);
+    void reportMemory(MemoryReport *report);
     
 private:
     Player *_player;    // seeker origin
@@ -126,9 +186,11 @@ private:
     int _returnX;
     int _returnY;
     
-    Pivot *_pivots;
-    int _numberOfPivots;
-    int _pivotsCapacity;
+    PivotChain _pivots;
+    
+    // reused by every step
+    CollisionReportContainer _collisions;
+    CollisionReportContainer _platformCollisions;
 };
 
 class Rope {
@@ -136,6 +198,9 @@ public:
     Rope(Player *p, int gX, int gY);
     ~Rope();
     
+    // attached at gX, gY with no pivots
+    void reset(int gX, int gY);
+    
     double getAccelerationX();
     double getAccelerationY();
     
@@ -146,15 +211,18 @@ public:
     void increaseSlack();
     void decreaseSlack();
     
-    Pivot *getPivots();
+    PivotChain *getPivots();
     void setNumberOfPivots(int x);
     
+    // takes over pivots (a seeker's, say) and leaves it with the rope's old ones
+    void takePivots(PivotChain *pivots);
+    
     void addPivot(Platform *platform, int corner);
     
     bool update(Level *level);
     
-    void draw(SDL_Renderer *renderer);
-    void draw(SDL_Renderer *renderer, double cameraX, double cameraY);
+    void snapshot(GrappleSnapshot *grapple);
+    void reportMemory(MemoryReport *report);
     
 private:
     Player *_player;
@@ -162,15 +230,17 @@ private:
     int _grappleX;
     int _grappleY;
     
-    Pivot *_pivots;
-    int _numberOfPivots;
-    int _pivotsCapacity;
+    PivotChain _pivots;
     
     double _ropeLength;
     double _angle;
     double _stretch;
     
     double _previousAngle;
+    
+    // reused by every update
+    CollisionReportContainer _collisions;
+    CollisionReportContainer _platformCollisions;
 };
 
 #endif
@@ -1,10 +1,67 @@
+#include <algorithm>
 #include <iostream>
-#include <fstream>
 #include <filesystem>
+#include <string.h>
 
 #include "level.hpp"
+#include "filewriter.hpp"
+#include "mappedfile.hpp"
+#include "stream.hpp"
+#include "levelpack.hpp"
+#include "profiler.hpp"
+#include "stats.hpp"
+#include "memory.hpp"
+#include "allocations.hpp"
 
-const string FILE_VERSION_INDICATOR = "A";
+const string FILE_VERSION_INDICATOR = "B";
+const string TEXT_FILE_VERSION_INDICATOR = "A";
+const string CHUNKED_FILE_VERSION_INDICATOR = "C";
+const string RUN_LENGTH_FILE_VERSION_INDICATOR = "D";
+
+const char EMPTY_TILE = '0';
+const char START_TILE = '1';
+const char END_TILE = '2';
+const char FIRST_PLATFORM_TILE = '3';
+
+const Uint64 FNV_OFFSET_BASIS = 14695981039346656037ULL;
+const Uint64 FNV_PRIME = 1099511628211ULL;
+
+static_assert(sizeof(LevelFileHeader) == 48, "LevelFileHeader must not contain padding");
+
+Uint64 fnv1a(const void *data, size_t size, Uint64 hash) {
+    const Uint8 *bytes = static_cast<const Uint8 *>(data);
+    for (size_t i = 0; i < size; i++) {
+        hash ^= bytes[i];
+        hash *= FNV_PRIME;
+    }
+    
+    return hash;
+}
+
+size_t packedTilesSize(int width, int height) {
+    return (static_cast<size_t>(width) * height + 1) / 2;
+}
+
+int countPackedPlatforms(const Uint8 *tiles, int width, int height) {
+    int numberOfPlatforms = 0;
+    
+    size_t numberOfTiles = static_cast<size_t>(width) * height;
+    for (size_t tile = 0; tile < numberOfTiles; tile++) {
+        int type = (tiles[tile / 2] >> ((tile % 2) * 4)) & 0x0F;
+        if (type != 0 && type <= NUMBER_OF_PLATFORM_TYPES) {
+            numberOfPlatforms++;
+        }
+    }
+    
+    return numberOfPlatforms;
+}
+
+Uint64 hashLevelContents(const Uint8 *tiles, int width, int height, int startX, int startY, int endX, int endY) {
+    Sint32 positions[6] = { SDL_SwapLE32(width), SDL_SwapLE32(height), SDL_SwapLE32(startX), SDL_SwapLE32(startY), SDL_SwapLE32(endX), SDL_SwapLE32(endY) };
+    
+    Uint64 hash = fnv1a(positions, sizeof(positions), FNV_OFFSET_BASIS);
+    return fnv1a(tiles, packedTilesSize(width, height), hash);
+}
 
 Platform::Platform() {
     _x = 0;
@@ -92,6 +149,7 @@ void Platform::draw(SDL_Renderer *renderer, double cameraX, double cameraY) {
         
     SDL_Rect rect = { _x - static_cast<int>(cameraX), _y - static_cast<int>(cameraY), _width, _height };
     SDL_RenderFillRect(renderer, &rect);
+    COUNT_STAT(DRAW_CALLS, 1);
 }
 
 Level::Level() {
@@ -108,20 +166,58 @@ Level::Level() {
     _maxY = MAP_HEIGHT * PLATFORM_HEIGHT;
     
     _fastestTime = -1;
+    
+    _revision = 0;
+    
+    _contentHash = 0;
+    
+    _tileIndex = NULL;
+    _tileIndexX = 0;
+    _tileIndexY = 0;
+    _tileIndexWidth = 0;
+    _tileIndexHeight = 0;
+    _tileIndexCapacity = 0;
+    _tileIndexValid = false;
+    _tileIndexShared = false;
+    
+    _editLogStart = 0;
+    _editLogLength = 0;
+    
+    _stream = NULL;
+    
+    _copySource = NULL;
 }
 
 Level::~Level() {
+    delete _stream;
+    
     delete[] _platforms;
+    delete[] _tileIndex;
 }
 
 int Level::platformExists(int x, int y) {
-    for (int i = 0; i < _numberOfPlatforms; i++) {
-        if (_platforms[i].getX() == x && _platforms[i].getY() == y) {
-            return i;
+    // only tile aligned platforms are indexed
+    if (x % PLATFORM_WIDTH != 0 || y % PLATFORM_HEIGHT != 0) {
+        for (int i = 0; i < _numberOfPlatforms; i++) {
+            if (_platforms[i].getX() == x && _platforms[i].getY() == y) {
+                return i;
+            }
         }
+        
+        return -1;
+    }
+    
+    if (!_tileIndexValid) {
+        rebuildTileIndex();
     }
     
-    return -1;
+    int tileX = x / PLATFORM_WIDTH - _tileIndexX;
+    int tileY = y / PLATFORM_HEIGHT - _tileIndexY;
+    if (tileX < 0 || tileX >= _tileIndexWidth || tileY < 0 || tileY >= _tileIndexHeight) {
+        return -1;
+    }
+    
+    return _tileIndex[static_cast<size_t>(tileY) * _tileIndexWidth + tileX];
 }
 
 int Level::getStartX() {
@@ -133,6 +229,10 @@ int Level::getStartY() {
 }
 
 void Level::setStartPos(int x, int y) {
+    _revision++;
+    logEdit(_startX, _startY, PLATFORM_WIDTH, PLATFORM_HEIGHT);
+    logEdit(x, y, PLATFORM_WIDTH, PLATFORM_HEIGHT);
+    
     _startX = x;
     _startY = y;
 }
@@ -158,6 +258,10 @@ int Level::getEndY() {
 }
 
 void Level::setEndPos(int x, int y) {
+    _revision++;
+    logEdit(_endX, _endY, PLATFORM_WIDTH, PLATFORM_HEIGHT);
+    logEdit(x, y, PLATFORM_WIDTH, PLATFORM_HEIGHT);
+    
     _endX = x;
     _endY = y;
 }
@@ -240,6 +344,9 @@ void Level::correctLevel() {
         _maxY = MAP_HEIGHT * PLATFORM_HEIGHT - 1;
     }
     
+    _revision++;
+    _tileIndexValid = false;
+
 //    printf("MaxX: %d, MinX: %d, MaxY: %d, MinY: %d\n", _maxX, minX, _maxY, minY);
 }
 
@@ -251,6 +358,21 @@ void Level::addPlatform(int x, int y, int w, int h, int type) {
     _platforms[_numberOfPlatforms].setType(type);
     
     _numberOfPlatforms++;
+    _revision++;
+    logEdit(x, y, w, h);
+    
+    if (_tileIndexValid && x % PLATFORM_WIDTH == 0 && y % PLATFORM_HEIGHT == 0) {
+        int tileX = x / PLATFORM_WIDTH - _tileIndexX;
+        int tileY = y / PLATFORM_HEIGHT - _tileIndexY;
+        
+        if (tileX < 0 || tileX >= _tileIndexWidth || tileY < 0 || tileY >= _tileIndexHeight) {
+            _tileIndexValid = false;
+        } else if (_tileIndex[static_cast<size_t>(tileY) * _tileIndexWidth + tileX] < 0) {
+            _tileIndex[static_cast<size_t>(tileY) * _tileIndexWidth + tileX] = _numberOfPlatforms - 1;
+        } else {
+            _tileIndexShared = true;
+        }
+    }
     
     if (_numberOfPlatforms >= _platformsCapacity) {
         _platformsCapacity *= 2;
@@ -269,21 +391,92 @@ void Level::addPlatform(int x, int y, int w, int h, int type) {
     }
 }
 
+void Level::addPlatforms(int x, int y, int count, int type) {
+    if (count <= 0) {
+        return;
+    }
+    
+    // grow once for the whole run, keeping a free slot the way addPlatform does
+    if (_numberOfPlatforms + count >= _platformsCapacity) {
+        int capacity = max(_platformsCapacity * 2, _numberOfPlatforms + count + 1);
+        
+        Platform *newPlatforms = new Platform[capacity];
+        copy(_platforms, _platforms + _numberOfPlatforms, newPlatforms);
+        delete[] _platforms;
+        
+        _platforms = newPlatforms;
+        _platformsCapacity = capacity;
+    }
+    
+    bool indexed = _tileIndexValid && x % PLATFORM_WIDTH == 0 && y % PLATFORM_HEIGHT == 0;
+    int tileX = x / PLATFORM_WIDTH - _tileIndexX;
+    int tileY = y / PLATFORM_HEIGHT - _tileIndexY;
+    
+    if (indexed && (tileX < 0 || tileX + count > _tileIndexWidth || tileY < 0 || tileY >= _tileIndexHeight)) {
+        _tileIndexValid = false;
+        indexed = false;
+    }
+    
+    for (int i = 0; i < count; i++) {
+        _platforms[_numberOfPlatforms] = Platform(x + i * PLATFORM_WIDTH, y, PLATFORM_WIDTH, PLATFORM_HEIGHT, type);
+        
+        if (indexed && _tileIndex[static_cast<size_t>(tileY) * _tileIndexWidth + tileX + i] < 0) {
+            _tileIndex[static_cast<size_t>(tileY) * _tileIndexWidth + tileX + i] = _numberOfPlatforms;
+        } else if (indexed) {
+            _tileIndexShared = true;
+        }
+        
+        _numberOfPlatforms++;
+    }
+    
+    _revision++;
+    logEdit(x, y, count * PLATFORM_WIDTH, PLATFORM_HEIGHT);
+}
+
 void Level::removePlatform(int i) {
-    for (int j = i + 1; j < _numberOfPlatforms; j++) {
-        _platforms[j - 1] = _platforms[j];
+    _revision++;
+    logEdit(_platforms[i].getX(), _platforms[i].getY(), _platforms[i].getWidth(), _platforms[i].getHeight());
+    
+    int last = _numberOfPlatforms - 1;
+    
+    // only two entries change: i's tile is emptied and the last platform's points at i
+    if (_tileIndexValid) {
+        int *entry = getTileIndexEntry(_platforms + i);
+        if (entry && *entry == i) {
+            *entry = -1;
+            
+            // another platform on the same tile should show through, which takes a rebuild to find
+            if (_tileIndexShared) {
+                _tileIndexValid = false;
+            }
+        }
+        
+        entry = getTileIndexEntry(_platforms + last);
+        if (entry && *entry == last) {
+            *entry = i;
+        }
     }
+    
+    _platforms[i] = _platforms[last];
     _numberOfPlatforms--;
 }
 
 void Level::resetLevel() {
-    int totalPlatforms = _numberOfPlatforms;
-    for (int i = 0; i < totalPlatforms; i++) {
-        removePlatform(0);
-    }
+    // removing one platform at a time shifts the whole array each time, which takes forever on big levels
+    _numberOfPlatforms = 0;
+    
+    delete _stream;
+    _stream = NULL;
+    
+    _revision++;
+    _tileIndexValid = false;
 }
 
 Platform *Level::getPlatform(int i) {
+    if (_stream) {
+        return _stream->getPlatform(i);
+    }
+    
     if (i >= 0 && i < _numberOfPlatforms) {
         return _platforms + i;
     }
@@ -292,6 +485,10 @@ Platform *Level::getPlatform(int i) {
 }
 
 int Level::getNumberOfPlatforms() {
+    if (_stream) {
+        return _stream->getNumberOfPlatforms();
+    }
+    
     return _numberOfPlatforms;
 }
 
@@ -303,135 +500,1079 @@ void Level::setFastestTime(double fastestTime) {
     _fastestTime = fastestTime;
 }
 
+int Level::getRevision() {
+    return _revision;
+}
+
+void Level::copyGeometry(Level *level) {
+    if (_copySource != level || !copyEdits(level)) {
+        // a streamed level only has its resident platforms, which the getters return
+        int numberOfPlatforms = level->getNumberOfPlatforms();
+        if (numberOfPlatforms >= _platformsCapacity) {
+            delete[] _platforms;
+            
+            _platformsCapacity = numberOfPlatforms * 2;
+            _platforms = new Platform[_platformsCapacity];
+        }
+        
+        for (int i = 0; i < numberOfPlatforms; i++) {
+            _platforms[i] = *level->getPlatform(i);
+        }
+        _numberOfPlatforms = numberOfPlatforms;
+        _tileIndexValid = false;
+        
+        _copySource = level;
+    }
+    
+    _startX = level->_startX;
+    _startY = level->_startY;
+    _endX = level->_endX;
+    _endY = level->_endY;
+    _maxX = level->_maxX;
+    _maxY = level->_maxY;
+    
+    _revision = level->_revision;
+    
+    for (int i = 0; i < level->_editLogLength; i++) {
+        int j = (level->_editLogStart + i) % EDIT_LOG_SIZE;
+        _editLog[j] = level->_editLog[j];
+    }
+    _editLogStart = level->_editLogStart;
+    _editLogLength = level->_editLogLength;
+}
+
+bool Level::copyEdits(Level *level) {
+    if (level->_stream) {
+        return false;
+    }
+    
+    SDL_Rect areas[EDIT_LOG_SIZE];
+    int numberOfAreas;
+    if (!level->getEditsSince(_revision, areas, &numberOfAreas)) {
+        return false;
+    }
+    
+    // the tiles are looked up in both tile indexes, so anything off the grid means copying the lot
+    for (int i = 0; i < numberOfAreas; i++) {
+        if (areas[i].x % PLATFORM_WIDTH != 0 || areas[i].y % PLATFORM_HEIGHT != 0 || areas[i].w % PLATFORM_WIDTH != 0 || areas[i].h % PLATFORM_HEIGHT != 0) {
+            return false;
+        }
+    }
+    
+    for (int i = 0; i < numberOfAreas; i++) {
+        for (int y = areas[i].y; y < areas[i].y + areas[i].h; y += PLATFORM_HEIGHT) {
+            for (int x = areas[i].x; x < areas[i].x + areas[i].w; x += PLATFORM_WIDTH) {
+                int platform = platformExists(x, y);
+                if (platform >= 0) {
+                    removePlatform(platform);
+                }
+                
+                platform = level->platformExists(x, y);
+                if (platform >= 0) {
+                    Platform *source = level->getPlatform(platform);
+                    addPlatform(source->getX(), source->getY(), source->getWidth(), source->getHeight(), source->getType());
+                }
+            }
+        }
+    }
+    
+    return true;
+}
+
+bool Level::getEditsSince(int revision, SDL_Rect areas[EDIT_LOG_SIZE], int *numberOfAreas) {
+    *numberOfAreas = 0;
+    
+    // walk back from the newest edit; every revision after the given one has to show up
+    int expectedRevision = _revision;
+    int i;
+    for (i = _editLogLength - 1; i >= 0; i--) {
+        LevelEdit *edit = _editLog + (_editLogStart + i) % EDIT_LOG_SIZE;
+        
+        if (edit->revision <= revision) {
+            break;
+        }
+        
+        if (edit->revision == expectedRevision - 1 && *numberOfAreas > 0) {
+            expectedRevision--;
+        } else if (edit->revision != expectedRevision) {
+            return false;
+        }
+        
+        areas[*numberOfAreas] = edit->area;
+        (*numberOfAreas)++;
+    }
+    
+    // a full log that ran out may have lost part of the oldest revision
+    if (i < 0 && _editLogLength == EDIT_LOG_SIZE) {
+        return false;
+    }
+    
+    return revision == _revision || expectedRevision == revision + 1;
+}
+
+void Level::logEdit(int x, int y, int w, int h) {
+    int i;
+    if (_editLogLength < EDIT_LOG_SIZE) {
+        i = (_editLogStart + _editLogLength) % EDIT_LOG_SIZE;
+        _editLogLength++;
+    } else {
+        i = _editLogStart;
+        _editLogStart = (_editLogStart + 1) % EDIT_LOG_SIZE;
+    }
+    
+    _editLog[i].area.x = x;
+    _editLog[i].area.y = y;
+    _editLog[i].area.w = w;
+    _editLog[i].area.h = h;
+    _editLog[i].revision = _revision;
+}
+
+void Level::reservePlatforms(int numberOfPlatforms) {
+    if (numberOfPlatforms >= _platformsCapacity) {
+        delete[] _platforms;
+        
+        _platformsCapacity = numberOfPlatforms + 1;
+        _platforms = new Platform[_platformsCapacity];
+    }
+    
+    _numberOfPlatforms = 0;
+}
+
+void Level::resizeTileIndex(int x, int y, int width, int height) {
+    size_t size = static_cast<size_t>(width) * height;
+    if (size > _tileIndexCapacity) {
+        delete[] _tileIndex;
+        
+        _tileIndex = new int[size];
+        _tileIndexCapacity = size;
+    }
+    
+    _tileIndexX = x;
+    _tileIndexY = y;
+    _tileIndexWidth = width;
+    _tileIndexHeight = height;
+    
+    fill(_tileIndex, _tileIndex + size, -1);
+    
+    _tileIndexValid = true;
+    _tileIndexShared = false;
+}
+
+void Level::releaseSurplusCapacity() {
+    // the free slot addPlatform always keeps stays
+    if (_platformsCapacity > _numberOfPlatforms + 1) {
+        Platform *platforms = new Platform[_numberOfPlatforms + 1];
+        copy(_platforms, _platforms + _numberOfPlatforms, platforms);
+        delete[] _platforms;
+        
+        _platforms = platforms;
+        _platformsCapacity = _numberOfPlatforms + 1;
+    }
+    
+    size_t tileIndexSize = _tileIndexValid ? static_cast<size_t>(_tileIndexWidth) * _tileIndexHeight : 0;
+    if (_tileIndexCapacity > tileIndexSize) {
+        int *tileIndex = tileIndexSize > 0 ? new int[tileIndexSize] : NULL;
+        copy(_tileIndex, _tileIndex + tileIndexSize, tileIndex);
+        delete[] _tileIndex;
+        
+        _tileIndex = tileIndex;
+        _tileIndexCapacity = tileIndexSize;
+    }
+}
+
+int *Level::getTileIndexEntry(Platform *platform) {
+    if (platform->getX() % PLATFORM_WIDTH != 0 || platform->getY() % PLATFORM_HEIGHT != 0) {
+        return NULL;
+    }
+    
+    int tileX = platform->getX() / PLATFORM_WIDTH - _tileIndexX;
+    int tileY = platform->getY() / PLATFORM_HEIGHT - _tileIndexY;
+    if (tileX < 0 || tileX >= _tileIndexWidth || tileY < 0 || tileY >= _tileIndexHeight) {
+        return NULL;
+    }
+    
+    return _tileIndex + static_cast<size_t>(tileY) * _tileIndexWidth + tileX;
+}
+
+void Level::rebuildTileIndex() {
+    int minX = SDL_MAX_SINT32;
+    int minY = SDL_MAX_SINT32;
+    int maxX = SDL_MIN_SINT32;
+    int maxY = SDL_MIN_SINT32;
+    
+    for (int i = 0; i < _numberOfPlatforms; i++) {
+        if (_platforms[i].getX() % PLATFORM_WIDTH != 0 || _platforms[i].getY() % PLATFORM_HEIGHT != 0) {
+            continue;
+        }
+        
+        minX = min(minX, _platforms[i].getX() / PLATFORM_WIDTH);
+        minY = min(minY, _platforms[i].getY() / PLATFORM_HEIGHT);
+        maxX = max(maxX, _platforms[i].getX() / PLATFORM_WIDTH);
+        maxY = max(maxY, _platforms[i].getY() / PLATFORM_HEIGHT);
+    }
+    
+    if (maxX < minX) {
+        resizeTileIndex(0, 0, 0, 0);
+        return;
+    }
+    
+    resizeTileIndex(minX, minY, maxX - minX + 1, maxY - minY + 1);
+    
+    // go backwards so the first of any overlapping platforms wins, like the old linear search
+    for (int i = _numberOfPlatforms - 1; i >= 0; i--) {
+        if (_platforms[i].getX() % PLATFORM_WIDTH != 0 || _platforms[i].getY() % PLATFORM_HEIGHT != 0) {
+            continue;
+        }
+        
+        int x = _platforms[i].getX() / PLATFORM_WIDTH - _tileIndexX;
+        int y = _platforms[i].getY() / PLATFORM_HEIGHT - _tileIndexY;
+        if (_tileIndex[static_cast<size_t>(y) * _tileIndexWidth + x] >= 0) {
+            _tileIndexShared = true;
+        }
+        _tileIndex[static_cast<size_t>(y) * _tileIndexWidth + x] = i;
+    }
+}
+
 void Level::draw(SDL_Renderer *renderer) {
     draw(renderer, 0, 0);
 }
 
 void Level::draw(SDL_Renderer *renderer, double cameraX, double cameraY) {
+    PROFILE_ZONE("Level::draw");
+    
+    SDL_Rect view = { static_cast<int>(cameraX), static_cast<int>(cameraY), MAP_WIDTH * PLATFORM_WIDTH, MAP_HEIGHT * PLATFORM_HEIGHT };
+    
     for (int i = 0; i < _numberOfPlatforms; i++) {
-        _platforms[i].draw(renderer, cameraX, cameraY);
+        // big levels have far more platforms off screen than on it
+        SDL_Rect platformRect = { _platforms[i].getX(), _platforms[i].getY(), _platforms[i].getWidth(), _platforms[i].getHeight() };
+        if (SDL_HasIntersection(&platformRect, &view)) {
+            _platforms[i].draw(renderer, cameraX, cameraY);
+        }
     }
     
     SDL_SetRenderDrawColor(renderer, 0xFF, 0xFF, 0x00, 0xFF);
     SDL_Rect endPosRect = { _endX - static_cast<int>(cameraX), _endY - static_cast<int>(cameraY), PLATFORM_WIDTH, PLATFORM_HEIGHT };
     
     SDL_RenderFillRect(renderer, &endPosRect);
+    COUNT_STAT(DRAW_CALLS, 1);
+}
+
+Uint64 Level::getContentHash() {
+    return _contentHash;
+}
+
+Uint8 *Level::packTiles(int width, int height, int *numberOfPlatforms) {
+    Uint8 *tiles = new Uint8[packedTilesSize(width, height)]();
+    *numberOfPlatforms = 0;
+    
+    // one pass over the platforms instead of a platformExists() search per tile
+    for (int i = 0; i < _numberOfPlatforms; i++) {
+        int x = _platforms[i].getX() / PLATFORM_WIDTH;
+        int y = _platforms[i].getY() / PLATFORM_HEIGHT;
+        if (x < 0 || x >= width || y < 0 || y >= height) {
+            continue;
+        }
+        
+        size_t tile = static_cast<size_t>(y) * width + x;
+        int shift = (tile % 2) * 4;
+        
+        if (((tiles[tile / 2] >> shift) & 0x0F) == 0) {
+            (*numberOfPlatforms)++;
+        }
+        
+        tiles[tile / 2] &= ~(0x0F << shift);
+        tiles[tile / 2] |= (_platforms[i].getType() + 1) << shift;
+    }
+    
+    return tiles;
+}
+
+Uint64 Level::hashContents(const Uint8 *tiles, int width, int height) {
+    return hashLevelContents(tiles, width, height, _startX, _startY, _endX, _endY);
+}
+
+void Level::fillFileHeader(LevelFileHeader *header, int width, int height, int numberOfPlatforms) {
+    header->headerSize = SDL_SwapLE32(sizeof(LevelFileHeader));
+    header->width = SDL_SwapLE32(width);
+    header->height = SDL_SwapLE32(height);
+    header->maxX = SDL_SwapLE32(_maxX);
+    header->maxY = SDL_SwapLE32(_maxY);
+    header->startX = SDL_SwapLE32(_startX);
+    header->startY = SDL_SwapLE32(_startY);
+    header->endX = SDL_SwapLE32(_endX);
+    header->endY = SDL_SwapLE32(_endY);
+    header->numberOfPlatforms = SDL_SwapLE32(numberOfPlatforms);
+    header->contentHash = SDL_SwapLE64(_contentHash);
+}
+
+void Level::saveLevel(string filename, FileWriter *writer) {
+    // a streamed level isn't all in memory, and can't have been edited either
+    if (_stream) {
+        return;
+    }
+    
+    filesystem::path filePath("levels/" + filename);
+    filePath.replace_extension("lvl");
+    
+    // the encoded file is the snapshot handed to the writer, so editing can carry on straight away
+    string contents;
+    encodeLevel(&contents);
+    
+    writeFile(filePath.string(), contents, writer);
+}
+
+void Level::encodeLevel(string *contents) {
+    int width = _maxX / PLATFORM_WIDTH + 1;
+    int height = _maxY / PLATFORM_HEIGHT + 1;
+    
+    int numberOfPlatforms;
+    Uint8 *tiles = packTiles(width, height, &numberOfPlatforms);
+    _contentHash = hashContents(tiles, width, height);
+    
+    LevelFileHeader header;
+    fillFileHeader(&header, width, height, numberOfPlatforms);
+    
+    *contents = FILE_VERSION_INDICATOR + '\n';
+    contents->reserve(contents->size() + sizeof(header) + packedTilesSize(width, height));
+    contents->append(reinterpret_cast<const char *>(&header), sizeof(header));
+    contents->append(reinterpret_cast<const char *>(tiles), packedTilesSize(width, height));
+    
+    delete[] tiles;
+}
+
+void Level::loadTiles(const Uint8 *tiles, int width, int height, int startX, int startY, int endX, int endY) {
+    delete _stream;
+    _stream = NULL;
+    
+    _startX = startX;
+    _startY = startY;
+    _endX = endX;
+    _endY = endY;
+    _maxX = width * PLATFORM_WIDTH - 1;
+    _maxY = height * PLATFORM_HEIGHT - 1;
+    
+    fillFromTiles(tiles, width, height, countPackedPlatforms(tiles, width, height));
+    
+    _contentHash = hashContents(tiles, width, height);
+    _fastestTime = -1;
+    
+    releaseSurplusCapacity();
+}
+
+void Level::encodeTiles(string *contents, const Uint8 *tiles, int width, int height, int startX, int startY, int endX, int endY) {
+    LevelFileHeader header;
+    header.headerSize = SDL_SwapLE32(sizeof(LevelFileHeader));
+    header.width = SDL_SwapLE32(width);
+    header.height = SDL_SwapLE32(height);
+    header.maxX = SDL_SwapLE32(width * PLATFORM_WIDTH - 1);
+    header.maxY = SDL_SwapLE32(height * PLATFORM_HEIGHT - 1);
+    header.startX = SDL_SwapLE32(startX);
+    header.startY = SDL_SwapLE32(startY);
+    header.endX = SDL_SwapLE32(endX);
+    header.endY = SDL_SwapLE32(endY);
+    header.numberOfPlatforms = SDL_SwapLE32(countPackedPlatforms(tiles, width, height));
+    header.contentHash = SDL_SwapLE64(hashLevelContents(tiles, width, height, startX, startY, endX, endY));
+    
+    *contents = FILE_VERSION_INDICATOR + '\n';
+    contents->reserve(contents->size() + sizeof(header) + packedTilesSize(width, height));
+    contents->append(reinterpret_cast<const char *>(&header), sizeof(header));
+    contents->append(reinterpret_cast<const char *>(tiles), packedTilesSize(width, height));
+}
+
+void Level::saveChunkedLevel(string filename, FileWriter *writer) {
+    if (_stream) {
+        return;
+    }
+    
+    filesystem::path filePath("levels/" + filename);
+    filePath.replace_extension("lvl");
+    
+    int width = _maxX / PLATFORM_WIDTH + 1;
+    int height = _maxY / PLATFORM_HEIGHT + 1;
+    
+    // hashed the same way as "B", so converting between the two keeps the hash
+    int numberOfPlatforms;
+    Uint8 *tiles = packTiles(width, height, &numberOfPlatforms);
+    _contentHash = hashContents(tiles, width, height);
+    
+    LevelFileHeader header;
+    fillFileHeader(&header, width, height, numberOfPlatforms);
+    
+    // edge chunks are padded with empty tiles so every chunk sits at a fixed offset
+    int chunksAcross = (width + CHUNK_SIZE - 1) / CHUNK_SIZE;
+    int chunksDown = (height + CHUNK_SIZE - 1) / CHUNK_SIZE;
+    Uint8 chunk[CHUNK_BYTES];
+    
+    string contents = string(CHUNKED_FILE_VERSION_INDICATOR) + '\n';
+    contents.reserve(contents.size() + sizeof(header) + static_cast<size_t>(chunksAcross) * chunksDown * CHUNK_BYTES);
+    contents.append(reinterpret_cast<const char *>(&header), sizeof(header));
+    
+    for (int chunkY = 0; chunkY < chunksDown; chunkY++) {
+        for (int chunkX = 0; chunkX < chunksAcross; chunkX++) {
+            memset(chunk, 0, CHUNK_BYTES);
+            
+            for (int y = 0; y < CHUNK_SIZE && chunkY * CHUNK_SIZE + y < height; y++) {
+                for (int x = 0; x < CHUNK_SIZE && chunkX * CHUNK_SIZE + x < width; x++) {
+                    size_t tile = static_cast<size_t>(chunkY * CHUNK_SIZE + y) * width + chunkX * CHUNK_SIZE + x;
+                    int type = (tiles[tile / 2] >> ((tile % 2) * 4)) & 0x0F;
+                    
+                    int chunkTile = y * CHUNK_SIZE + x;
+                    chunk[chunkTile / 2] |= type << ((chunkTile % 2) * 4);
+                }
+            }
+            
+            contents.append(reinterpret_cast<const char *>(chunk), CHUNK_BYTES);
+        }
+    }
+    
+    delete[] tiles;
+    
+    writeFile(filePath.string(), contents, writer);
 }
 
-void Level::saveLevel(string filename) {
+void Level::saveRunLengthLevel(string filename, FileWriter *writer) {
+    if (_stream) {
+        return;
+    }
+    
     filesystem::path filePath("levels/" + filename);
     filePath.replace_extension("lvl");
     
-    ofstream file;
-    file.open(filePath.string());
+    int width = _maxX / PLATFORM_WIDTH + 1;
+    int height = _maxY / PLATFORM_HEIGHT + 1;
+    
+    int numberOfPlatforms;
+    Uint8 *tiles = packTiles(width, height, &numberOfPlatforms);
+    _contentHash = hashContents(tiles, width, height);
     
-    file << FILE_VERSION_INDICATOR << '\n';
+    int startTileX = _startX / PLATFORM_WIDTH;
+    int startTileY = _startY / PLATFORM_HEIGHT;
+    int endTileX = _endX / PLATFORM_WIDTH;
+    int endTileY = _endY / PLATFORM_HEIGHT;
     
-    for (int y = 0; y <= _maxY / PLATFORM_HEIGHT; y++) {
-        for (int x = 0; x <= _maxX / PLATFORM_HEIGHT; x++) {
-            int platform = platformExists(x * PLATFORM_WIDTH, y * PLATFORM_HEIGHT);
-            if (platform >= 0) {
-                file.put(_platforms[platform].getType() + 51);
-            } else if (_endX == x * PLATFORM_WIDTH && _endY == y * PLATFORM_HEIGHT) {
-                file.put('2');
-            } else if (_startX == x * PLATFORM_WIDTH && _startY == y * PLATFORM_HEIGHT) {
-                file.put('1');
+    string contents = RUN_LENGTH_FILE_VERSION_INDICATOR + '\n';
+    
+    // one line per row of "<tile>" or "<tile>*<count>" runs; the empty run at the end of a row is left off
+    for (int y = 0; y < height; y++) {
+        int runTile = EMPTY_TILE;
+        int runLength = 0;
+        bool firstRun = true;
+        
+        for (int x = 0; x <= width; x++) {
+            int tile = EMPTY_TILE;
+            if (x == width) {
+                tile = -1;
+            } else if (x == startTileX && y == startTileY) {
+                tile = START_TILE;
+            } else if (x == endTileX && y == endTileY) {
+                tile = END_TILE;
             } else {
-                file.put('0');
+                size_t i = static_cast<size_t>(y) * width + x;
+                int type = (tiles[i / 2] >> ((i % 2) * 4)) & 0x0F;
+                if (type > 0) {
+                    tile = FIRST_PLATFORM_TILE + type - 1;
+                }
             }
+            
+            if (tile == runTile) {
+                runLength++;
+                continue;
+            }
+            
+            if (runLength > 0 && !(tile == -1 && runTile == EMPTY_TILE)) {
+                if (!firstRun) {
+                    contents += ' ';
+                }
+                contents += static_cast<char>(runTile);
+                if (runLength > 1) {
+                    contents += '*';
+                    contents += to_string(runLength);
+                }
+                firstRun = false;
+            }
+            
+            runTile = tile;
+            runLength = 1;
         }
         
-        file.put('\n');
+        contents += '\n';
     }
     
-    file.close();
+    delete[] tiles;
     
-    filePath.replace_extension("hs");
-    file.open(filePath.string());
+    writeFile(filePath.string(), contents, writer);
+}
+
+void Level::writeFile(string path, const string &contents, FileWriter *writer) {
+    if (writer) {
+        writer->write(path, contents);
+    } else {
+        writeFileAtomically(path, contents);
+    }
+}
+
+bool Level::loadBinaryLevel(const char *data, size_t size) {
+    LevelFileHeader header;
+    if (size < sizeof(header)) {
+        printf("Couldn't load level. Error: truncated header\n");
+        return false;
+    }
     
-    file << to_string(getFastestTime()).c_str();
+    // the mapping has no alignment guarantees past the version line, so copy the header out
+    memcpy(&header, data, sizeof(header));
+    
+    // newer revisions may append header fields we don't know about
+    size_t headerSize = SDL_SwapLE32(header.headerSize);
+    if (headerSize < sizeof(header) || headerSize > size) {
+        printf("Couldn't load level. Error: bad header size %zu\n", headerSize);
+        return false;
+    }
+    
+    int width = SDL_SwapLE32(header.width);
+    int height = SDL_SwapLE32(header.height);
+    int numberOfPlatforms = SDL_SwapLE32(header.numberOfPlatforms);
+    
+    if (width <= 0 || height <= 0 || width > MAX_LEVEL_DIMENSION || height > MAX_LEVEL_DIMENSION ||
+        numberOfPlatforms < 0 || static_cast<size_t>(numberOfPlatforms) > static_cast<size_t>(width) * height) {
+        printf("Couldn't load level. Error: bad dimensions %dx%d with %d platforms\n", width, height, numberOfPlatforms);
+        return false;
+    }
+    
+    if (size - headerSize < packedTilesSize(width, height)) {
+        printf("Couldn't load level. Error: truncated tile data\n");
+        return false;
+    }
     
-    file.close();
+    const Uint8 *tiles = reinterpret_cast<const Uint8 *>(data + headerSize);
+    
+    _startX = SDL_SwapLE32(header.startX);
+    _startY = SDL_SwapLE32(header.startY);
+    _endX = SDL_SwapLE32(header.endX);
+    _endY = SDL_SwapLE32(header.endY);
+    _maxX = SDL_SwapLE32(header.maxX);
+    _maxY = SDL_SwapLE32(header.maxY);
+    
+    _contentHash = hashContents(tiles, width, height);
+    if (_contentHash != SDL_SwapLE64(header.contentHash)) {
+        printf("Level content hash doesn't match its header, the file may be corrupt\n");
+    }
+    
+    // platforms and the tile index are sized once from the header and filled straight from the tiles
+    fillFromTiles(tiles, width, height, numberOfPlatforms);
+    
+    return true;
 }
 
-void Level::loadLevel(string filename) {
-    filesystem::path filePath("levels/" + filename);
-    filePath.replace_extension("lvl");
+void Level::fillFromTiles(const Uint8 *tiles, int width, int height, int numberOfPlatforms) {
+    reservePlatforms(numberOfPlatforms);
+    resizeTileIndex(0, 0, width, height);
     
-    ifstream file;
-    file.open(filePath.string());
+    size_t numberOfTiles = static_cast<size_t>(width) * height;
+    for (size_t tile = 0; tile < numberOfTiles; tile++) {
+        int type = (tiles[tile / 2] >> ((tile % 2) * 4)) & 0x0F;
+        if (type == 0 || type > NUMBER_OF_PLATFORM_TYPES) {
+            continue;
+        }
+        
+        if (_numberOfPlatforms >= numberOfPlatforms) {
+            printf("Level has more platforms than its header says, ignoring the rest\n");
+            break;
+        }
+        
+        Platform *platform = _platforms + _numberOfPlatforms;
+        platform->setPos(static_cast<int>(tile % width) * PLATFORM_WIDTH, static_cast<int>(tile / width) * PLATFORM_HEIGHT);
+        platform->setWidth(PLATFORM_WIDTH);
+        platform->setHeight(PLATFORM_HEIGHT);
+        platform->setType(type - 1);
+        
+        _tileIndex[tile] = _numberOfPlatforms;
+        _numberOfPlatforms++;
+    }
+    
+    // the bounds come with the tiles, so there's no correctLevel() pass
+    _revision++;
+}
+
+bool Level::loadTextLevel(const char *data, size_t size) {
+    const char *end = data + size;
+    
+    // first pass checks every row, counts platforms and finds the bounds, all in tiles
+    int numberOfPlatforms = 0;
+    int width = -1;
+    int height = 0;
+    
+    int minX = SDL_MAX_SINT32;
+    int minY = SDL_MAX_SINT32;
+    int maxX = SDL_MIN_SINT32;
+    int maxY = SDL_MIN_SINT32;
+    
+    int startX = -1;
+    int startY = -1;
+    int endX = -1;
+    int endY = -1;
     
-    if (!file.fail()) {
-        string fileVersion;
-        file >> fileVersion;
+    const char *row = data;
+    while (row < end) {
+        const char *rowEnd = static_cast<const char *>(memchr(row, '\n', end - row));
+        if (!rowEnd) {
+            rowEnd = end;
+        }
         
-        char currentPos;
+        // files saved on windows
+        const char *cellsEnd = rowEnd;
+        if (cellsEnd > row && cellsEnd[-1] == '\r') {
+            cellsEnd--;
+        }
         
-        if (fileVersion == "A") {
-            file.seekg(1, ios_base::cur);
+        int rowLength = static_cast<int>(cellsEnd - row);
+        if (width < 0) {
+            width = rowLength;
             
-            int y = 0;
-            while (y >= 0) {
-                int x = 0;
-                while (true) {
-                    file.get(currentPos);
-                    
-                    if (file.eof()) {
-                        y = -2;
-                        break;
-                    }
+            if (width > MAX_LEVEL_DIMENSION) {
+                printf("Couldn't load level. Error: line %d: row is wider than %d tiles\n", height + 2, MAX_LEVEL_DIMENSION);
+                return false;
+            }
+        } else if (rowLength != width) {
+            printf("Couldn't load level. Error: line %d column %d: row is %d tiles wide, expected %d\n", height + 2, min(rowLength, width) + 1, rowLength, width);
+            return false;
+        }
+        
+        if (height >= MAX_LEVEL_DIMENSION) {
+            printf("Couldn't load level. Error: line %d: more than %d rows\n", height + 2, MAX_LEVEL_DIMENSION);
+            return false;
+        }
+        
+        for (int x = 0; x < rowLength; x++) {
+            char tile = row[x];
+            if (tile == EMPTY_TILE) {
+                continue;
+            }
+            
+            if (tile < EMPTY_TILE || tile >= FIRST_PLATFORM_TILE + NUMBER_OF_PLATFORM_TYPES) {
+                printf("Couldn't load level. Error: line %d column %d: bad tile '%c'\n", height + 2, x + 1, tile);
+                return false;
+            }
+            
+            if (tile == START_TILE) {
+                startX = x;
+                startY = height;
+            } else if (tile == END_TILE) {
+                endX = x;
+                endY = height;
+            } else {
+                numberOfPlatforms++;
+            }
+            
+            minX = min(minX, x);
+            minY = min(minY, height);
+            maxX = max(maxX, x);
+            maxY = max(maxY, height);
+        }
+        
+        row = rowEnd + 1;
+        height++;
+    }
+    
+    // a file without a start or end keeps the current one, like correctLevel() would
+    if (startX < 0) {
+        startX = _startX / PLATFORM_WIDTH;
+        startY = _startY / PLATFORM_HEIGHT;
+        
+        minX = min(minX, startX);
+        minY = min(minY, startY);
+        maxX = max(maxX, startX);
+        maxY = max(maxY, startY);
+    }
+    
+    if (endX < 0) {
+        endX = _endX / PLATFORM_WIDTH;
+        endY = _endY / PLATFORM_HEIGHT;
+        
+        minX = min(minX, endX);
+        minY = min(minY, endY);
+        maxX = max(maxX, endX);
+        maxY = max(maxY, endY);
+    }
+    
+    // second pass fills the platforms and tile index already moved to the top left, so there's
+    // no correctLevel() or rebuildTileIndex() afterwards
+    reservePlatforms(numberOfPlatforms);
+    resizeTileIndex(0, 0, maxX - minX + 1, maxY - minY + 1);
+    
+    row = data;
+    for (int y = 0; y < height; y++) {
+        for (int x = 0; x < width; x++) {
+            char tile = row[x];
+            if (tile < FIRST_PLATFORM_TILE) {
+                continue;
+            }
+            
+            Platform *platform = _platforms + _numberOfPlatforms;
+            platform->setPos((x - minX) * PLATFORM_WIDTH, (y - minY) * PLATFORM_HEIGHT);
+            platform->setWidth(PLATFORM_WIDTH);
+            platform->setHeight(PLATFORM_HEIGHT);
+            platform->setType(tile - FIRST_PLATFORM_TILE);
+            
+            _tileIndex[static_cast<size_t>(y - minY) * _tileIndexWidth + x - minX] = _numberOfPlatforms;
+            _numberOfPlatforms++;
+        }
+        
+        const char *rowEnd = static_cast<const char *>(memchr(row, '\n', end - row));
+        row = rowEnd ? rowEnd + 1 : end;
+    }
+    
+    _startX = (startX - minX) * PLATFORM_WIDTH;
+    _startY = (startY - minY) * PLATFORM_HEIGHT;
+    _endX = (endX - minX) * PLATFORM_WIDTH;
+    _endY = (endY - minY) * PLATFORM_HEIGHT;
+    
+    // never smaller than one screen, same as correctLevel()
+    _maxX = max(maxX - minX + 1, MAP_WIDTH) * PLATFORM_WIDTH - 1;
+    _maxY = max(maxY - minY + 1, MAP_HEIGHT) * PLATFORM_HEIGHT - 1;
+    
+    _revision++;
+    
+    return true;
+}
+
+bool Level::loadLegacyLevel(const char *data, size_t size) {
+    reservePlatforms(MAP_WIDTH * MAP_HEIGHT);
+    
+    // a fixed size grid with no version line or line breaks
+    for (size_t i = 0; i < size && i < static_cast<size_t>(MAP_WIDTH * MAP_HEIGHT); i++) {
+        int x = i % MAP_WIDTH;
+        int y = i / MAP_WIDTH;
+        char currentPos = data[i];
+        
+        if (currentPos == '1') {
+            _startX = x * PLATFORM_WIDTH;
+            _startY = y * PLATFORM_HEIGHT;
+        } else if (currentPos == '2') {
+            _endX = x * PLATFORM_WIDTH;
+            _endY = y * PLATFORM_HEIGHT;
+        } else if (currentPos > '2') {
+            _platforms[_numberOfPlatforms] = Platform(x * PLATFORM_WIDTH, y * PLATFORM_HEIGHT, PLATFORM_WIDTH, PLATFORM_HEIGHT, currentPos - 51);
+            _numberOfPlatforms++;
+        }
+    }
+    
+    return true;
+}
+
+bool Level::loadRunLengthLevel(const char *data, size_t size) {
+    // two passes over the runs: the first checks them and counts platforms, the second adds them
+    for (int pass = 0; pass < 2; pass++) {
+        int numberOfPlatforms = 0;
+        
+        const char *end = data + size;
+        const char *row = data;
+        int y = 0;
+        
+        while (row < end) {
+            const char *rowEnd = static_cast<const char *>(memchr(row, '\n', end - row));
+            if (!rowEnd) {
+                rowEnd = end;
+            }
+            
+            // files saved on windows
+            const char *runsEnd = rowEnd;
+            if (runsEnd > row && runsEnd[-1] == '\r') {
+                runsEnd--;
+            }
+            
+            int x = 0;
+            const char *c = row;
+            while (c < runsEnd) {
+                if (*c == ' ') {
+                    c++;
+                    continue;
+                }
+                
+                char tile = *c;
+                int column = static_cast<int>(c - row) + 1;
+                c++;
+                
+                if (tile < EMPTY_TILE || tile >= FIRST_PLATFORM_TILE + NUMBER_OF_PLATFORM_TYPES) {
+                    printf("Couldn't load level. Error: line %d column %d: bad tile '%c'\n", y + 2, column, tile);
+                    return false;
+                }
+                
+                int count = 1;
+                if (c < runsEnd && *c == '*') {
+                    c++;
                     
-                    if (currentPos == '\n') {
-                        break;
+                    count = 0;
+                    const char *digits = c;
+                    while (c < runsEnd && *c >= '0' && *c <= '9' && count <= MAX_LEVEL_DIMENSION) {
+                        count = count * 10 + (*c - '0');
+                        c++;
                     }
                     
-                    if (currentPos == '1') {
-                        setStartPos(x * PLATFORM_WIDTH, y * PLATFORM_HEIGHT);
-                    } else if (currentPos == '2') {
-                        setEndPos(x * PLATFORM_WIDTH, y * PLATFORM_WIDTH);
-                    } else if (currentPos > '2') {
-                        addPlatform(x * PLATFORM_WIDTH, y * PLATFORM_HEIGHT, PLATFORM_WIDTH, PLATFORM_HEIGHT, currentPos - 51);
+                    if (c == digits || count <= 0 || count > MAX_LEVEL_DIMENSION) {
+                        printf("Couldn't load level. Error: line %d column %d: bad run length\n", y + 2, static_cast<int>(digits - row) + 1);
+                        return false;
                     }
-                    
-                    x++;
                 }
                 
-                y++;
-            }
-        } else {
-            // reset file read position
-            file.seekg(0);
-            
-            for (int y = 0; y < MAP_HEIGHT; y++) {
-                for (int x = 0; x < MAP_WIDTH; x++) {
-                    file.get(currentPos);
+                if (tile == START_TILE || tile == END_TILE) {
+                    if (count != 1) {
+                        printf("Couldn't load level. Error: line %d column %d: start and end can't repeat\n", y + 2, column);
+                        return false;
+                    }
                     
-                    if (currentPos == '1') {
-                        setStartPos(x * PLATFORM_WIDTH, y * PLATFORM_HEIGHT);
-                    } else if (currentPos == '2') {
-                        setEndPos(x * PLATFORM_WIDTH, y * PLATFORM_WIDTH);
-                    } else if (currentPos > '2') {
-                        addPlatform(x * PLATFORM_WIDTH, y * PLATFORM_HEIGHT, PLATFORM_WIDTH, PLATFORM_HEIGHT, currentPos - 51);
+                    if (pass == 1 && tile == START_TILE) {
+                        _startX = x * PLATFORM_WIDTH;
+                        _startY = y * PLATFORM_HEIGHT;
+                    } else if (pass == 1) {
+                        _endX = x * PLATFORM_WIDTH;
+                        _endY = y * PLATFORM_HEIGHT;
+                    }
+                } else if (tile >= FIRST_PLATFORM_TILE) {
+                    if (pass == 0) {
+                        numberOfPlatforms += count;
+                    } else {
+                        addPlatforms(x * PLATFORM_WIDTH, y * PLATFORM_HEIGHT, count, tile - FIRST_PLATFORM_TILE);
                     }
                 }
+                
+                x += count;
+                if (x > MAX_LEVEL_DIMENSION) {
+                    printf("Couldn't load level. Error: line %d: row is wider than %d tiles\n", y + 2, MAX_LEVEL_DIMENSION);
+                    return false;
+                }
             }
+            
+            row = rowEnd + 1;
+            y++;
         }
         
-        correctLevel();
+        if (pass == 0) {
+            reservePlatforms(numberOfPlatforms);
+            _tileIndexValid = false;
+        }
     }
     
-    file.close();
+    return true;
+}
+
+bool Level::loadChunkedLevel(const char *data, size_t size, string filename, size_t dataOffset) {
+    LevelFileHeader header;
+    if (size < sizeof(header)) {
+        printf("Couldn't load level. Error: truncated header\n");
+        return false;
+    }
+    
+    memcpy(&header, data, sizeof(header));
+    
+    size_t headerSize = SDL_SwapLE32(header.headerSize);
+    if (headerSize < sizeof(header) || headerSize > size) {
+        printf("Couldn't load level. Error: bad header size %zu\n", headerSize);
+        return false;
+    }
     
-    filePath.replace_extension("hs");
-    file.open(filePath.string());
+    int width = SDL_SwapLE32(header.width);
+    int height = SDL_SwapLE32(header.height);
     
-    string fastestTimeString;
-    if (!file.fail()) {
-        file >> fastestTimeString;
-        _fastestTime = stod(fastestTimeString);
+    if (width <= 0 || height <= 0 || width > MAX_STREAMED_LEVEL_DIMENSION || height > MAX_STREAMED_LEVEL_DIMENSION) {
+        printf("Couldn't load level. Error: bad dimensions %dx%d\n", width, height);
+        return false;
+    }
+    
+    _startX = SDL_SwapLE32(header.startX);
+    _startY = SDL_SwapLE32(header.startY);
+    _endX = SDL_SwapLE32(header.endX);
+    _endY = SDL_SwapLE32(header.endY);
+    _maxX = SDL_SwapLE32(header.maxX);
+    _maxY = SDL_SwapLE32(header.maxY);
+    
+    // checking the hash would mean reading the whole level, which is what streaming avoids
+    _contentHash = SDL_SwapLE64(header.contentHash);
+    
+    _numberOfPlatforms = 0;
+    _tileIndexValid = false;
+    
+    _stream = new LevelStream();
+    if (!_stream->open(filename, dataOffset + headerSize, width, height)) {
+        delete _stream;
+        _stream = NULL;
+        return false;
+    }
+    
+    _revision++;
+    
+    return true;
+}
+
+bool Level::isStreaming() {
+    return _stream != NULL;
+}
+
+void Level::updateStreaming(int x, int y, int w, int h) {
+    if (_stream && _stream->update(x, y, w, h)) {
+        _revision++;
+    }
+}
+
+void Level::reportMemory(MemoryReport *report) {
+    report->add(PLATFORM_STORAGE, _numberOfPlatforms * sizeof(Platform), _platformsCapacity * sizeof(Platform));
+    
+    if (_tileIndex) {
+        size_t used = _tileIndexValid ? static_cast<size_t>(_tileIndexWidth) * _tileIndexHeight : 0;
+        report->add(TILE_INDEX, used * sizeof(int), _tileIndexCapacity * sizeof(int));
+    }
+    
+    if (_stream) {
+        _stream->reportMemory(report);
+    }
+}
+
+void Level::requireArea(int x, int y, int w, int h) {
+    if (!_stream) {
+        return;
+    }
+    
+    // taking in chunks allocates their platforms, which the player's tick has to wait for anyway
+    const char *hotPath = suspendHotPath();
+    bool changed = _stream->require(x, y, w, h);
+    resumeHotPath(hotPath);
+    
+    if (changed) {
+        _revision++;
+    }
+}
+
+bool Level::readSummary(string filename, int *width, int *height, Uint64 *contentHash) {
+    filesystem::path filePath("levels/" + filename);
+    filePath.replace_extension("lvl");
+    
+    MappedFile levelFile;
+    if (!levelFile.open(filePath.string())) {
+        return false;
+    }
+    
+    const char *data = levelFile.getData();
+    size_t size = levelFile.getSize();
+    
+    const char *lineEnd = size > 0 ? static_cast<const char *>(memchr(data, '\n', size)) : NULL;
+    size_t versionLength = lineEnd ? lineEnd - data : 0;
+    
+    string fileVersion(data, versionLength);
+    if (!fileVersion.empty() && fileVersion.back() == '\r') {
+        fileVersion.pop_back();
+    }
+    
+    if (lineEnd && (fileVersion == FILE_VERSION_INDICATOR || fileVersion == CHUNKED_FILE_VERSION_INDICATOR)) {
+        LevelFileHeader header;
+        if (size - versionLength - 1 < sizeof(header)) {
+            return false;
+        }
+        
+        memcpy(&header, lineEnd + 1, sizeof(header));
+        *width = SDL_SwapLE32(header.width);
+        *height = SDL_SwapLE32(header.height);
+        *contentHash = SDL_SwapLE64(header.contentHash);
+        
+        return true;
+    }
+    
+    // sized the way the binary formats are, from the loaded level's bounds
+    Level level;
+    if (!level.loadLevel(filename)) {
+        return false;
+    }
+    
+    *width = level.getMaxX() / PLATFORM_WIDTH + 1;
+    *height = level.getMaxY() / PLATFORM_HEIGHT + 1;
+    *contentHash = level.getContentHash();
+    
+    return true;
+}
+
+bool Level::loadLevel(string filename) {
+    filesystem::path filePath("levels/" + filename);
+    filePath.replace_extension("lvl");
+    
+    MappedFile levelFile;
+    
+    if (!levelFile.open(filePath.string())) {
+        printf("Couldn't load level. Error: couldn't open %s\n", filePath.string().c_str());
+        return false;
+    }
+    
+    bool loaded = loadLevelData(levelFile.getData(), levelFile.getSize(), filePath.string(), 0);
+    
+    levelFile.close();
+    
+    return loaded;
+}
+
+bool Level::loadPackedLevel(LevelPack *pack, int i) {
+    size_t size;
+    const char *data = pack->getLevelData(i, &size);
+    
+    if (!data) {
+        return false;
+    }
+    
+    return loadLevelData(data, size, pack->getFilename(), data - pack->getData());
+}
+
+bool Level::loadLevelData(const char *data, size_t size, string filename, size_t fileOffset) {
+    delete _stream;
+    _stream = NULL;
+    
+    // the version is the whole first line; legacy files don't have one
+    const char *lineEnd = size > 0 ? static_cast<const char *>(memchr(data, '\n', size)) : NULL;
+    size_t versionLength = lineEnd ? lineEnd - data : 0;
+    
+    string fileVersion(data, versionLength);
+    if (!fileVersion.empty() && fileVersion.back() == '\r') {
+        fileVersion.pop_back();
+    }
+    
+    bool loaded;
+    if (lineEnd && fileVersion == FILE_VERSION_INDICATOR) {
+        loaded = loadBinaryLevel(lineEnd + 1, size - versionLength - 1);
+    } else if (lineEnd && fileVersion == CHUNKED_FILE_VERSION_INDICATOR) {
+        loaded = loadChunkedLevel(lineEnd + 1, size - versionLength - 1, filename, fileOffset + versionLength + 1);
     } else {
-        _fastestTime = -1;
+        if (lineEnd && fileVersion == TEXT_FILE_VERSION_INDICATOR) {
+            // bounds and the tile index are worked out while parsing
+            loaded = loadTextLevel(lineEnd + 1, size - versionLength - 1);
+        } else {
+            if (lineEnd && fileVersion == RUN_LENGTH_FILE_VERSION_INDICATOR) {
+                loaded = loadRunLengthLevel(lineEnd + 1, size - versionLength - 1);
+            } else {
+                loaded = loadLegacyLevel(data, size);
+            }
+            
+            if (loaded) {
+                correctLevel();
+                rebuildTileIndex();
+            }
+        }
+        
+        if (loaded) {
+            int width = _maxX / PLATFORM_WIDTH + 1;
+            int height = _maxY / PLATFORM_HEIGHT + 1;
+            
+            int numberOfPlatforms;
+            Uint8 *tiles = packTiles(width, height, &numberOfPlatforms);
+            _contentHash = hashContents(tiles, width, height);
+            delete[] tiles;
+        }
+    }
+    
+    // times live in the score store, keyed by the content hash worked out above
+    _fastestTime = -1;
+    
+    if (!loaded) {
+        // the loaders stop at the first problem, so whatever they'd already read goes too
+        resetLevel();
+        _contentHash = 0;
     }
     
-    file.close();
+    releaseSurplusCapacity();
+    
+    return loaded;
 }
@@ -31,6 +31,37 @@ const int PLATFORM_HEIGHT = 32;
 const int MAP_WIDTH = 25;
 const int MAP_HEIGHT = 15;
 
+const int EDIT_LOG_SIZE = 64;
+
+// "B" files can't be bigger than this many tiles in either direction
+const int MAX_LEVEL_DIMENSION = 32768;
+
+// streamed "C" files can be much bigger, since they're never all in memory at once
+const int MAX_STREAMED_LEVEL_DIMENSION = 1 << 20;
+
+// header of a "B" level file, stored little-endian right after the "B" line and followed by
+// the tiles, two per byte (low nibble first), 0 for empty and platform type + 1 otherwise.
+// "C" files use the same header but store the tiles chunk by chunk (see stream.hpp)
+struct LevelFileHeader {
+    Uint32 headerSize;
+    Uint32 width;
+    Uint32 height;
+    Sint32 maxX;
+    Sint32 maxY;
+    Sint32 startX;
+    Sint32 startY;
+    Sint32 endX;
+    Sint32 endY;
+    Uint32 numberOfPlatforms;
+    Uint64 contentHash;
+};
+
+// area touched by a single change to the level, so renderers can repaint only that
+struct LevelEdit {
+    SDL_Rect area;
+    int revision;
+};
+
 class Platform {
 public:
     Platform();
@@ -63,6 +94,11 @@ private:
     int _type;
 };
 
+class LevelStream;
+class FileWriter;
+class LevelPack;
+class MemoryReport;
+
 class Level {
 public:
     Level();
@@ -89,6 +125,11 @@ public:
     int platformExists(int x, int y);
     
     void addPlatform(int x, int y, int w, int h, int type);
+    
+    // a row of count tile sized platforms starting at x, y, added in one go
+    void addPlatforms(int x, int y, int count, int type);
+    
+    // the last platform is moved into i's place, so the others keep their indices
     void removePlatform(int i);
     void resetLevel();
     Platform *getPlatform(int i);
@@ -98,11 +139,59 @@ public:
     double getFastestTime();
     void setFastestTime(double fastestTime);
     
+    // bumped on every change to the geometry, so copies know when they're stale
+    int getRevision();
+    
+    // brings this copy up to date with level. a copy of the same level that's only a few edits
+    // behind just takes the tiles those edits touched
+    void copyGeometry(Level *level);
+    
+    // fills areas with everything changed after the given revision. returns false if that can't be
+    // described from the edit log (too many edits, or something like correctLevel moved everything)
+    bool getEditsSince(int revision, SDL_Rect areas[EDIT_LOG_SIZE], int *numberOfAreas);
+    
     void draw(SDL_Renderer *renderer);
     void draw(SDL_Renderer *renderer, double cameraX, double cameraY);
     
-    void saveLevel(string filename);
-    void loadLevel(string filename);
+    // FNV-1a hash of the tiles and start/end, the same whichever format the level was loaded from
+    Uint64 getContentHash();
+    
+    // with a writer the file is written on its thread, otherwise before returning. either way the
+    // old file is only replaced once the new one is completely on disk
+    void saveLevel(string filename, FileWriter *writer);
+    void saveChunkedLevel(string filename, FileWriter *writer);
+    
+    // "D": text with each row stored as runs of the same tile, for levels kept in version control
+    void saveRunLengthLevel(string filename, FileWriter *writer);
+    
+    // false if the level couldn't be read. a missing file leaves the level as it was; a bad one
+    // leaves it empty, since the loaders can give up partway through
+    bool loadLevel(string filename);
+    bool loadPackedLevel(LevelPack *pack, int i);
+    
+    // the level as a "B" file, which is also how packs store it
+    void encodeLevel(string *contents);
+    
+    // tiles packed the way "B" files store them, for tools that build levels a tile at a time.
+    // start and end are in pixels. encodeTiles makes the file without ever building the platforms
+    void loadTiles(const Uint8 *tiles, int width, int height, int startX, int startY, int endX, int endY);
+    static void encodeTiles(string *contents, const Uint8 *tiles, int width, int height, int startX, int startY, int endX, int endY);
+    
+    // size of a level file in tiles and its content hash. binary levels have both in their header
+    // and aren't loaded; the others have to be loaded to hash them
+    static bool readSummary(string filename, int *width, int *height, Uint64 *contentHash);
+    
+    // "C" levels are streamed in around the camera instead of loaded whole. they can be played
+    // but not edited, and only the platforms in resident chunks are visible
+    bool isStreaming();
+    void updateStreaming(int x, int y, int w, int h);
+    
+    // collision code calls this with the area it's about to test; blocks until it's loaded. it isn't
+    // checked by --hot-allocations, since streaming allocates whenever a chunk comes in
+    void requireArea(int x, int y, int w, int h);
+    
+    // platforms, tile index and resident chunks, into the report's current section
+    void reportMemory(MemoryReport *report);
     
 private:
     int _startX;
@@ -119,6 +208,64 @@ private:
     int _platformsCapacity;
     
     double _fastestTime;
+    
+    int _revision;
+    
+    Uint64 _contentHash;
+    
+    // tiles packed the way "B" files store them; the caller deletes the returned array
+    Uint8 *packTiles(int width, int height, int *numberOfPlatforms);
+    Uint64 hashContents(const Uint8 *tiles, int width, int height);
+    
+    // platforms in a grid over their bounding box, so platformExists() doesn't search every platform.
+    // rebuilt lazily after anything that moves platforms
+    int *_tileIndex;
+    int _tileIndexX;
+    int _tileIndexY;
+    int _tileIndexWidth;
+    int _tileIndexHeight;
+    size_t _tileIndexCapacity;
+    bool _tileIndexValid;
+    
+    // some tile has more than one platform, so emptying its slot could hide the others
+    bool _tileIndexShared;
+    
+    void reservePlatforms(int numberOfPlatforms);
+    void resizeTileIndex(int x, int y, int width, int height);
+    void rebuildTileIndex();
+    
+    // after loading, so a small level doesn't keep the storage a bigger one before it grew
+    void releaseSurplusCapacity();
+    
+    // the index slot for platform's tile, or NULL if it isn't tile aligned or the index doesn't cover it
+    int *getTileIndexEntry(Platform *platform);
+    
+    // the level copyGeometry last copied, and the edits it can catch up with from there
+    Level *_copySource;
+    bool copyEdits(Level *level);
+    
+    // fill the level straight from the file's bytes (after the version line, if there is one)
+    bool loadBinaryLevel(const char *data, size_t size);
+    void fillFromTiles(const Uint8 *tiles, int width, int height, int numberOfPlatforms);
+    bool loadTextLevel(const char *data, size_t size);
+    bool loadLegacyLevel(const char *data, size_t size);
+    bool loadChunkedLevel(const char *data, size_t size, string filename, size_t dataOffset);
+    bool loadRunLengthLevel(const char *data, size_t size);
+    
+    // picks the loader from the version line. filename and fileOffset say where data sits on disk,
+    // for streamed levels that read the rest of it themselves
+    bool loadLevelData(const char *data, size_t size, string filename, size_t fileOffset);
+    
+    void fillFileHeader(LevelFileHeader *header, int width, int height, int numberOfPlatforms);
+    void writeFile(string path, const string &contents, FileWriter *writer);
+    
+    LevelStream *_stream;
+    
+    void logEdit(int x, int y, int w, int h);
+    
+    LevelEdit _editLog[EDIT_LOG_SIZE];
+    int _editLogStart;
+    int _editLogLength;
 };
 
 #endif
@@ -0,0 +1,314 @@
+#include <fstream>
+#include <filesystem>
+
+#include "levelindex.hpp"
+#include "level.hpp"
+#include "levelpack.hpp"
+
+Sint64 modificationTime(filesystem::path path) {
+    error_code error;
+    filesystem::file_time_type time = filesystem::last_write_time(path, error);
+    
+    if (error) {
+        return -1;
+    }
+    
+    return time.time_since_epoch().count();
+}
+
+LevelIndex::LevelIndex() {
+    _thread = NULL;
+    _mutex = NULL;
+    _refreshRequested = NULL;
+    
+    _generation = 0;
+    _refreshPending = false;
+    _scanning = false;
+    _stopping = false;
+}
+
+LevelIndex::~LevelIndex() {
+    stop();
+}
+
+bool LevelIndex::start() {
+    _mutex = SDL_CreateMutex();
+    _refreshRequested = SDL_CreateCond();
+    if (!_mutex || !_refreshRequested) {
+        printf("Couldn't create level index locks. Error: %s\n", SDL_GetError());
+        return false;
+    }
+    
+    loadCache();
+    
+    _refreshPending = true;
+    _scanning = true;
+    _stopping = false;
+    
+    _thread = SDL_CreateThread(scanLevels, "level index", this);
+    if (!_thread) {
+        printf("Couldn't create level index thread. Error: %s\n", SDL_GetError());
+        return false;
+    }
+    
+    return true;
+}
+
+void LevelIndex::stop() {
+    if (_thread) {
+        SDL_LockMutex(_mutex);
+        _stopping = true;
+        SDL_CondSignal(_refreshRequested);
+        SDL_UnlockMutex(_mutex);
+        
+        SDL_WaitThread(_thread, NULL);
+        _thread = NULL;
+    }
+    
+    SDL_DestroyCond(_refreshRequested);
+    SDL_DestroyMutex(_mutex);
+    _refreshRequested = NULL;
+    _mutex = NULL;
+}
+
+void LevelIndex::refresh() {
+    SDL_LockMutex(_mutex);
+    _refreshPending = true;
+    _scanning = true;
+    SDL_CondSignal(_refreshRequested);
+    SDL_UnlockMutex(_mutex);
+}
+
+bool LevelIndex::isScanning() {
+    SDL_LockMutex(_mutex);
+    bool scanning = _scanning;
+    SDL_UnlockMutex(_mutex);
+    
+    return scanning;
+}
+
+int LevelIndex::getGeneration() {
+    SDL_LockMutex(_mutex);
+    int generation = _generation;
+    SDL_UnlockMutex(_mutex);
+    
+    return generation;
+}
+
+void LevelIndex::getEntries(vector<LevelIndexEntry> *entries) {
+    entries->clear();
+    
+    SDL_LockMutex(_mutex);
+    for (map<string, LevelIndexEntry>::iterator i = _entries.begin(); i != _entries.end(); i++) {
+        entries->push_back(i->second);
+    }
+    SDL_UnlockMutex(_mutex);
+}
+
+int LevelIndex::scanLevels(void *data) {
+    LevelIndex *index = static_cast<LevelIndex *>(data);
+    
+    SDL_LockMutex(index->_mutex);
+    while (true) {
+        while (!index->_refreshPending && !index->_stopping) {
+            SDL_CondWait(index->_refreshRequested, index->_mutex);
+        }
+        
+        if (index->_stopping) {
+            break;
+        }
+        
+        index->_refreshPending = false;
+        
+        SDL_UnlockMutex(index->_mutex);
+        index->scan();
+        SDL_LockMutex(index->_mutex);
+        
+        // another refresh may have come in while scanning
+        if (!index->_refreshPending) {
+            index->_scanning = false;
+        }
+    }
+    SDL_UnlockMutex(index->_mutex);
+    
+    return 0;
+}
+
+void LevelIndex::scan() {
+    bool changed = false;
+    
+    map<string, LevelIndexEntry> known;
+    SDL_LockMutex(_mutex);
+    known = _entries;
+    SDL_UnlockMutex(_mutex);
+    
+    error_code error;
+    for (filesystem::directory_iterator i("levels", error); !error && i != filesystem::directory_iterator(); i.increment(error)) {
+        if (i->path().extension() == PACK_EXTENSION) {
+            Sint64 modified = modificationTime(i->path());
+            Uint64 size = i->file_size(error);
+            error.clear();
+            
+            changed = scanPack(i->path(), modified, size, &known) || changed;
+            continue;
+        }
+        
+        if (i->path().extension() != ".lvl") {
+            continue;
+        }
+        
+        string name = i->path().filename().replace_extension("").string();
+        
+        Sint64 modified = modificationTime(i->path());
+        Uint64 size = i->file_size(error);
+        error.clear();
+        
+        map<string, LevelIndexEntry>::iterator cached = known.find(name);
+        if (cached != known.end()) {
+            bool unchanged = cached->second.modified == modified && cached->second.size == size;
+            known.erase(cached);
+            
+            if (unchanged) {
+                continue;
+            }
+        }
+        
+        LevelIndexEntry entry;
+        entry.name = name;
+        entry.modified = modified;
+        entry.size = size;
+        if (!readEntry(name, &entry)) {
+            continue;
+        }
+        
+        SDL_LockMutex(_mutex);
+        _entries[name] = entry;
+        _generation++;
+        SDL_UnlockMutex(_mutex);
+        
+        changed = true;
+    }
+    
+    // whatever's left wasn't found on disk any more
+    if (!known.empty()) {
+        SDL_LockMutex(_mutex);
+        for (map<string, LevelIndexEntry>::iterator i = known.begin(); i != known.end(); i++) {
+            _entries.erase(i->first);
+        }
+        _generation++;
+        SDL_UnlockMutex(_mutex);
+        
+        changed = true;
+    }
+    
+    if (changed) {
+        saveCache();
+    }
+}
+
+bool LevelIndex::scanPack(filesystem::path path, Sint64 modified, Uint64 size, map<string, LevelIndexEntry> *known) {
+    string pack = path.filename().replace_extension("").string();
+    string prefix = pack + "/";
+    
+    // all of a pack's entries were read together, so checking the first one covers the rest
+    map<string, LevelIndexEntry>::iterator first = known->lower_bound(prefix);
+    bool cached = first != known->end() && first->first.compare(0, prefix.size(), prefix) == 0;
+    if (cached && first->second.modified == modified && first->second.size == size) {
+        while (first != known->end() && first->first.compare(0, prefix.size(), prefix) == 0) {
+            first = known->erase(first);
+        }
+        
+        return false;
+    }
+    
+    LevelPack levelPack;
+    if (!levelPack.open(path.string())) {
+        return false;
+    }
+    
+    // only the table of contents is read; levels that left the pack stay in known and get removed
+    SDL_LockMutex(_mutex);
+    for (int i = 0; i < levelPack.getNumberOfLevels(); i++) {
+        LevelPackEntry packEntry = levelPack.getEntry(i);
+        
+        LevelIndexEntry entry;
+        entry.name = prefix + packEntry.name;
+        entry.pack = pack;
+        entry.modified = modified;
+        entry.size = size;
+        entry.width = packEntry.width;
+        entry.height = packEntry.height;
+        entry.contentHash = packEntry.contentHash;
+        
+        _entries[entry.name] = entry;
+        known->erase(entry.name);
+    }
+    _generation++;
+    SDL_UnlockMutex(_mutex);
+    
+    return true;
+}
+
+bool LevelIndex::readEntry(string name, LevelIndexEntry *entry) {
+    return Level::readSummary(name, &entry->width, &entry->height, &entry->contentHash);
+}
+
+void LevelIndex::loadCache() {
+    ifstream file;
+    file.open(LEVEL_INDEX_FILENAME);
+    
+    if (file.fail()) {
+        return;
+    }
+    
+    string version;
+    getline(file, version);
+    
+    // an old or broken cache just means a full scan
+    if (version != LEVEL_INDEX_VERSION) {
+        return;
+    }
+    
+    string name;
+    while (getline(file, name, '\t')) {
+        LevelIndexEntry entry;
+        entry.name = name;
+        getline(file, entry.pack, '\t');
+        file >> entry.modified >> entry.size >> entry.width >> entry.height >> entry.contentHash;
+        file.ignore(1);
+        
+        if (file.fail()) {
+            break;
+        }
+        
+        _entries[name] = entry;
+    }
+    
+    _generation++;
+    
+    file.close();
+}
+
+void LevelIndex::saveCache() {
+    vector<LevelIndexEntry> entries;
+    getEntries(&entries);
+    
+    // write next to the real cache and swap it in, so a crash never leaves half an index
+    string temporaryFilename = LEVEL_INDEX_FILENAME + ".tmp";
+    
+    ofstream file;
+    file.open(temporaryFilename);
+    
+    file << LEVEL_INDEX_VERSION << '\n';
+    for (int i = 0; i < static_cast<int>(entries.size()); i++) {
+        file << entries[i].name << '\t' << entries[i].pack << '\t' << entries[i].modified << ' ' << entries[i].size << ' ' << entries[i].width << ' ' << entries[i].height << ' ' << entries[i].contentHash << '\n';
+    }
+    
+    file.close();
+    
+    error_code error;
+    filesystem::rename(temporaryFilename, LEVEL_INDEX_FILENAME, error);
+    if (error) {
+        printf("Couldn't save level index. Error: %s\n", error.message().c_str());
+    }
+}
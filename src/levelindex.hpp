@@ -0,0 +1,81 @@
+#ifndef levelindex_hpp
+#define levelindex_hpp
+
+#if defined __APPLE__ || defined __linux__
+#include <SDL2/SDL.h>
+#endif
+
+#ifdef _WIN64
+#include <SDL.h>
+#endif
+
+#include <filesystem>
+#include <map>
+#include <vector>
+#include <string>
+using namespace std;
+
+const string LEVEL_INDEX_FILENAME = "levels/levels.index";
+const string LEVEL_INDEX_VERSION = "I4";
+
+// what the level selector shows about a level without loading it
+struct LevelIndexEntry {
+    // "pack/level" for levels in a pack
+    string name;
+    string pack;
+    
+    // of the pack, for packed levels
+    Sint64 modified;
+    Uint64 size;
+    
+    int width;
+    int height;
+    
+    // the score store's key for its fastest time
+    Uint64 contentHash;
+};
+
+// every level in the levels directory and in the packs there, cached on disk and kept up to date
+// by a worker thread that only rereads files whose modification time or size changed since the last scan
+class LevelIndex {
+public:
+    LevelIndex();
+    ~LevelIndex();
+    
+    // loads the cached index and starts the worker, which does a first scan straight away
+    bool start();
+    void stop();
+    
+    // asks the worker for another scan; entries stay available while it runs
+    void refresh();
+    bool isScanning();
+    
+    // bumped whenever an entry is added, changed or removed
+    int getGeneration();
+    
+    // sorted by name
+    void getEntries(vector<LevelIndexEntry> *entries);
+    
+private:
+    static int scanLevels(void *data);
+    void scan();
+    
+    bool readEntry(string name, LevelIndexEntry *entry);
+    bool scanPack(filesystem::path path, Sint64 modified, Uint64 size, map<string, LevelIndexEntry> *known);
+    
+    void loadCache();
+    void saveCache();
+    
+    SDL_Thread *_thread;
+    SDL_mutex *_mutex;
+    SDL_cond *_refreshRequested;
+    
+    // guarded by _mutex
+    map<string, LevelIndexEntry> _entries;
+    int _generation;
+    bool _refreshPending;
+    bool _scanning;
+    bool _stopping;
+};
+
+#endif
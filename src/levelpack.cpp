@@ -0,0 +1,194 @@
+#include <algorithm>
+#include <string.h>
+
+#include "levelpack.hpp"
+#include "level.hpp"
+#include "filewriter.hpp"
+
+static_assert(sizeof(LevelPackHeader) == 16, "LevelPackHeader must not contain padding");
+static_assert(sizeof(LevelPackEntry) == 96, "LevelPackEntry must not contain padding");
+
+LevelPack::LevelPack() {
+    _toc = NULL;
+    _numberOfLevels = 0;
+}
+
+bool LevelPack::open(string filename) {
+    close();
+    
+    if (!_file.open(filename)) {
+        printf("Couldn't open level pack %s\n", filename.c_str());
+        return false;
+    }
+    
+    const char *data = _file.getData();
+    size_t size = _file.getSize();
+    size_t versionLength = PACK_FILE_VERSION_INDICATOR.size() + 1;
+    
+    LevelPackHeader header;
+    if (size < versionLength + sizeof(header) || memcmp(data, (PACK_FILE_VERSION_INDICATOR + '\n').c_str(), versionLength) != 0) {
+        printf("Couldn't open level pack %s. Error: not a level pack\n", filename.c_str());
+        close();
+        return false;
+    }
+    
+    memcpy(&header, data + versionLength, sizeof(header));
+    
+    Uint64 tocOffset = SDL_SwapLE64(header.tocOffset);
+    Uint32 numberOfLevels = SDL_SwapLE32(header.numberOfLevels);
+    
+    if (SDL_SwapLE32(header.headerSize) < sizeof(header) || tocOffset > size || numberOfLevels > (size - tocOffset) / sizeof(LevelPackEntry)) {
+        printf("Couldn't open level pack %s. Error: bad table of contents\n", filename.c_str());
+        close();
+        return false;
+    }
+    
+    _filename = filename;
+    _toc = data + tocOffset;
+    _numberOfLevels = numberOfLevels;
+    
+    return true;
+}
+
+void LevelPack::close() {
+    _file.close();
+    _filename.clear();
+    
+    _toc = NULL;
+    _numberOfLevels = 0;
+}
+
+string LevelPack::getFilename() {
+    return _filename;
+}
+
+const char *LevelPack::getData() {
+    return _file.getData();
+}
+
+int LevelPack::getNumberOfLevels() {
+    return _numberOfLevels;
+}
+
+LevelPackEntry LevelPack::getEntry(int i) {
+    LevelPackEntry entry;
+    memcpy(&entry, _toc + static_cast<size_t>(i) * sizeof(LevelPackEntry), sizeof(entry));
+    
+    entry.name[MAX_PACKED_NAME_LENGTH] = '\0';
+    entry.offset = SDL_SwapLE64(entry.offset);
+    entry.length = SDL_SwapLE64(entry.length);
+    entry.contentHash = SDL_SwapLE64(entry.contentHash);
+    entry.width = SDL_SwapLE32(entry.width);
+    entry.height = SDL_SwapLE32(entry.height);
+    
+    return entry;
+}
+
+int LevelPack::find(string name) {
+    // names sit at the start of each entry, so they can be compared in place
+    int low = 0;
+    int high = _numberOfLevels - 1;
+    while (low <= high) {
+        int middle = (low + high) / 2;
+        
+        const char *entryName = _toc + static_cast<size_t>(middle) * sizeof(LevelPackEntry);
+        int comparison = strncmp(name.c_str(), entryName, MAX_PACKED_NAME_LENGTH + 1);
+        
+        if (comparison == 0) {
+            return middle;
+        } else if (comparison < 0) {
+            high = middle - 1;
+        } else {
+            low = middle + 1;
+        }
+    }
+    
+    return -1;
+}
+
+const char *LevelPack::getLevelData(int i, size_t *size) {
+    if (i < 0 || i >= _numberOfLevels) {
+        return NULL;
+    }
+    
+    LevelPackEntry entry = getEntry(i);
+    if (entry.offset > _file.getSize() || entry.length > _file.getSize() - entry.offset) {
+        printf("Couldn't read %s from level pack %s. Error: entry is outside the pack\n", entry.name, _filename.c_str());
+        return NULL;
+    }
+    
+    *size = entry.length;
+    return _file.getData() + entry.offset;
+}
+
+bool LevelPack::build(string filename, vector<string> levelNames) {
+    sort(levelNames.begin(), levelNames.end());
+    
+    vector<LevelPackEntry> entries;
+    string levels;
+    
+    for (int i = 0; i < static_cast<int>(levelNames.size()); i++) {
+        if (levelNames[i].size() > MAX_PACKED_NAME_LENGTH) {
+            printf("Skipping %s, names in a pack can't be longer than %d characters\n", levelNames[i].c_str(), MAX_PACKED_NAME_LENGTH);
+            continue;
+        }
+        
+        Level level;
+        if (!level.loadLevel(levelNames[i])) {
+            printf("Skipping %s, it couldn't be loaded\n", levelNames[i].c_str());
+            continue;
+        }
+        
+        if (level.isStreaming()) {
+            printf("Skipping %s, streamed levels can't be packed\n", levelNames[i].c_str());
+            continue;
+        }
+        
+        string contents;
+        level.encodeLevel(&contents);
+        
+        LevelPackEntry entry;
+        memset(&entry, 0, sizeof(entry));
+        strncpy(entry.name, levelNames[i].c_str(), MAX_PACKED_NAME_LENGTH);
+        entry.offset = levels.size();
+        entry.length = contents.size();
+        entry.contentHash = level.getContentHash();
+        entry.width = level.getMaxX() / PLATFORM_WIDTH + 1;
+        entry.height = level.getMaxY() / PLATFORM_HEIGHT + 1;
+        entries.push_back(entry);
+        
+        levels += contents;
+    }
+    
+    LevelPackHeader header;
+    header.headerSize = SDL_SwapLE32(sizeof(header));
+    header.numberOfLevels = SDL_SwapLE32(static_cast<Uint32>(entries.size()));
+    
+    Uint64 tocOffset = PACK_FILE_VERSION_INDICATOR.size() + 1 + sizeof(header);
+    Uint64 levelsOffset = tocOffset + entries.size() * sizeof(LevelPackEntry);
+    header.tocOffset = SDL_SwapLE64(tocOffset);
+    
+    string contents = PACK_FILE_VERSION_INDICATOR + '\n';
+    contents.reserve(levelsOffset + levels.size());
+    contents.append(reinterpret_cast<const char *>(&header), sizeof(header));
+    
+    for (int i = 0; i < static_cast<int>(entries.size()); i++) {
+        entries[i].offset = SDL_SwapLE64(entries[i].offset + levelsOffset);
+        entries[i].length = SDL_SwapLE64(entries[i].length);
+        entries[i].contentHash = SDL_SwapLE64(entries[i].contentHash);
+        entries[i].width = SDL_SwapLE32(entries[i].width);
+        entries[i].height = SDL_SwapLE32(entries[i].height);
+        
+        contents.append(reinterpret_cast<const char *>(&entries[i]), sizeof(entries[i]));
+    }
+    
+    contents += levels;
+    
+    if (!writeFileAtomically(filename, contents)) {
+        return false;
+    }
+    
+    printf("Packed %d levels into %s\n", static_cast<int>(entries.size()), filename.c_str());
+    
+    return true;
+}
@@ -0,0 +1,75 @@
+#ifndef levelpack_hpp
+#define levelpack_hpp
+
+#if defined __APPLE__ || defined __linux__
+#include <SDL2/SDL.h>
+#endif
+
+#ifdef _WIN64
+#include <SDL.h>
+#endif
+
+#include <string>
+#include <vector>
+using namespace std;
+
+#include "mappedfile.hpp"
+
+const string PACK_FILE_VERSION_INDICATOR = "P";
+const string PACK_EXTENSION = ".pack";
+
+const int MAX_PACKED_NAME_LENGTH = 63;
+
+// header of a level pack, stored little-endian right after the "P" line. the table of contents
+// follows it, then the levels themselves, each one a whole "B" file
+struct LevelPackHeader {
+    Uint32 headerSize;
+    Uint32 numberOfLevels;
+    Uint64 tocOffset;
+};
+
+// one level in the table of contents, which is sorted by name. offsets are from the start of the pack
+struct LevelPackEntry {
+    char name[MAX_PACKED_NAME_LENGTH + 1];
+    Uint64 offset;
+    Uint64 length;
+    Uint64 contentHash;
+    Uint32 width;
+    Uint32 height;
+};
+
+// many levels in one mapped file; listing them only reads the table of contents, and a level's
+// data is a pointer straight into the mapping
+class LevelPack {
+public:
+    LevelPack();
+    
+    bool open(string filename);
+    void close();
+    
+    string getFilename();
+    const char *getData();
+    
+    int getNumberOfLevels();
+    
+    // copied out, since the mapping has no alignment guarantees
+    LevelPackEntry getEntry(int i);
+    
+    // -1 if there's no level with that name
+    int find(string name);
+    
+    // NULL if the entry points outside the pack
+    const char *getLevelData(int i, size_t *size);
+    
+    // packs the named levels from the levels directory; streamed levels are skipped
+    static bool build(string filename, vector<string> levelNames);
+    
+private:
+    MappedFile _file;
+    string _filename;
+    
+    const char *_toc;
+    int _numberOfLevels;
+};
+
+#endif
@@ -1,4 +1,5 @@
 #include <cstdio>
+#include <cstdlib>
 #include <filesystem>
 
 #ifdef __APPLE__
@@ -19,6 +20,17 @@
 #include "game.hpp"
 #include "level.hpp"
 #include "controls.hpp"
+#include "snapshot.hpp"
+#include "timing.hpp"
+#include "levelpack.hpp"
+#include "generator.hpp"
+#include "profiler.hpp"
+#include "stats.hpp"
+#include "overlay.hpp"
+#include "allocations.hpp"
+#include "replay.hpp"
+#include "watchdog.hpp"
+#include "memory.hpp"
 using namespace std;
 
 KeyboardLayout defaultLayout;
@@ -33,25 +45,150 @@ const int WINDOW_HEIGHT = MAP_HEIGHT * PLATFORM_HEIGHT;
 
 const int FPS = 60;
 
-char pressedLetters[50];
+bool vsync = false;
+bool printFrameStats = false;
+bool printStartupStats = false;
+bool printMemoryReport = false;
+
+// with --memory-report, a section for each level as it was loaded
+MemoryReport levelMemory;
+
+// with --trace, the last traceSeconds of profiling zones are written there on exit. F12 writes them any time
+string traceFilename;
+double traceSeconds = DEFAULT_TRACE_SECONDS;
+
+// with --record, every run at a loose level is saved there for umihara_bench --replay, each replacing the last
+string recordFilename;
+InputRecording recording;
+
+// with --frame-budget, frames of either loop that take longer (in ms) are reported to SLOW_FRAME_LOG_FILENAME
+double frameBudget = 0;
+FrameWatchdog frameWatchdog;
+
+// taken while globals are constructed, as close to process start as we can get
+Uint64 processStart = SDL_GetPerformanceCounter();
+
+FramePacer simulationPacer;
+FramePacer renderPacer;
+
+// everything the simulation counted, for --frame-stats
+StatTotals simulationTotals;
+Uint64 simulationTicks = 0;
+
+// F3 shows it
+PerformanceOverlay performanceOverlay;
+
+char pressedLetters[MAX_QUEUED_LETTERS];
 int numPressedLetters = 0;
 
+// the simulation runs on its own thread and hands the renderer a snapshot every tick
+SDL_atomic_t running;
+InputQueue inputQueue;
+SnapshotBuffer snapshots;
+
 bool init();
 void cleanUp();
 
+int simulate(void *data);
+void printPacerStats(string name, FramePacer *pacer);
+void printSimulationStats();
+void updateRecording(bool wasPlaying);
+void saveRecording();
+int buildLevelPack(string name);
+int convertLevel(string name, char format);
+int generateLevel(string name, int numberOfSettings, char *settings[]);
+void printStartup(Uint64 initDone, Uint64 gameInitDone, Uint64 firstFrame);
+
 int main(int argc, char* argv[]) {
     filesystem::path executablePath(argv[0]);
     filesystem::current_path(executablePath.parent_path());
     
-    if (!init() || !gameInit()) {
+    for (int i = 1; i < argc; i++) {
+        string argument = argv[i];
+        if (argument == "--vsync") {
+            vsync = true;
+        } else if (argument == "--frame-stats") {
+            printFrameStats = true;
+        } else if (argument == "--startup-stats") {
+            printStartupStats = true;
+        } else if (argument == "--memory-report") {
+            printMemoryReport = true;
+        } else if (argument == "--trace" && i + 1 < argc) {
+            traceFilename = argv[++i];
+        } else if (argument == "--trace-seconds" && i + 1 < argc) {
+            traceSeconds = atof(argv[++i]);
+        } else if (argument == "--record" && i + 1 < argc) {
+            recordFilename = argv[++i];
+        } else if (argument == "--frame-budget" && i + 1 < argc) {
+            frameBudget = atof(argv[++i]);
+        } else if (argument == "--hot-allocations" && i + 1 < argc) {
+            // report allocations inside the player's tick: log prints a backtrace, abort stops there.
+            // a streamed level's chunks are taken in without being checked
+            string policy = argv[++i];
+            if (!setHotAllocationPolicy(policy == "abort" ? ABORT_ON_HOT_ALLOCATIONS : policy == "log" ? LOG_HOT_ALLOCATIONS : ALLOW_HOT_ALLOCATIONS)) {
+                return -1;
+            }
+        } else if (argument == "--build-pack" && i + 1 < argc) {
+            return buildLevelPack(argv[i + 1]);
+        } else if (argument == "--chunk-level" && i + 1 < argc) {
+            // rewrites levels/<name>.lvl as a "C" level, streamed in around the camera when played
+            return convertLevel(argv[i + 1], 'C');
+        } else if (argument == "--run-length-level" && i + 1 < argc) {
+            // rewrites levels/<name>.lvl as a "D" level, text that diffs well in version control
+            return convertLevel(argv[i + 1], 'D');
+        } else if (argument == "--generate-level" && i + 1 < argc) {
+            // everything after the name is a name=value generator setting
+            return generateLevel(argv[i + 1], argc - i - 2, argv + i + 2);
+        }
+    }
+    
+    simulationPacer.setTargetFps(FPS);
+    renderPacer.setTargetFps(FPS);
+    renderPacer.setVsync(vsync);
+    
+    if (!init()) {
+        cleanUp();
+        return -1;
+    }
+    Uint64 initDone = SDL_GetPerformanceCounter();
+    
+    if (!gameInit()) {
+        cleanUp();
+        return -1;
+    }
+    
+    if (printMemoryReport) {
+        gameRecordLevelMemory(&levelMemory);
+    }
+    Uint64 gameInitDone = SDL_GetPerformanceCounter();
+    bool firstFrameShown = false;
+    
+    if (frameBudget > 0 && !frameWatchdog.start(SLOW_FRAME_LOG_FILENAME, frameBudget)) {
         cleanUp();
         return -1;
     }
     
+    PROFILE_THREAD("main");
+    
+    SDL_AtomicSet(&running, 1);
+    
+    SDL_Thread *simulationThread = SDL_CreateThread(simulate, "simulation", NULL);
+    if (simulationThread == NULL) {
+        printf("Couldn't create simulation thread. Error: %s\n", SDL_GetError());
+        cleanUp();
+        return -1;
+    }
+    
+    // what the last frame cost, for the overlay
+    StatCounts renderStats;
+    clearStats(&renderStats);
+    double drawTime = 0;
+    double presentTime = 0;
+    
     SDL_Event e;
-    bool running = true;
-    while (running) {
-        Uint32 startTicks = SDL_GetTicks();
+    while (SDL_AtomicGet(&running)) {
+        renderPacer.beginFrame();
+        Uint64 frameStart = SDL_GetPerformanceCounter();
         
         numPressedLetters = 0;
         
@@ -59,10 +196,16 @@ int main(int argc, char* argv[]) {
         
         while (SDL_PollEvent(&e)) {
             if (e.type == SDL_QUIT) {
-                running = false;
+                SDL_AtomicSet(&running, 0);
             } else if (e.type == SDL_KEYDOWN) {
+                if (e.key.keysym.scancode == SDL_SCANCODE_F12) {
+                    dumpProfile(TRACE_FILENAME, traceSeconds);
+                } else if (e.key.keysym.scancode == SDL_SCANCODE_F3) {
+                    performanceOverlay.toggle();
+                }
+                
                 string keyName = SDL_GetKeyName(e.key.keysym.sym);
-                if (keyName.length() == 1 && ((keyName[0] >= 'A' && keyName[0] <= 'Z') || (keyName[0] >= '0' && keyName[0] <= '9'))) {
+                if (keyName.length() == 1 && ((keyName[0] >= 'A' && keyName[0] <= 'Z') || (keyName[0] >= '0' && keyName[0] <= '9')) && numPressedLetters < MAX_QUEUED_LETTERS) {
                     pressedLetters[numPressedLetters] = keyName[0];
                     numPressedLetters++;
                 }
@@ -91,38 +234,201 @@ int main(int argc, char* argv[]) {
             }
         }
         
-        // update
-        const Uint8 *keys = SDL_GetKeyboardState(NULL);
-        activeKeyboardLayout->update(keys);
-        
-        if (!gameUpdate(activeKeyboardLayout, pressedLetters, numPressedLetters)) {
-            running = false;
-        }
+        // hand the input over to the simulation
+        inputQueue.push(SDL_GetKeyboardState(NULL), pressedLetters, numPressedLetters);
         
         SDL_SetRenderDrawColor(renderer, 0x00, 0x00, 0x00, 0xFF);
         SDL_RenderClear(renderer);
         
         // draw
-        gameDraw(renderer);
+        Uint64 drawStart = SDL_GetPerformanceCounter();
         
-        SDL_RenderPresent(renderer);
+        RenderSnapshot *snapshot = snapshots.acquire();
+        if (snapshot) {
+            gameDraw(renderer, snapshot);
+            
+            // its text opens fonts and counts textures alongside the simulation thread's screen text
+            gameLockUi();
+            performanceOverlay.draw(renderer, snapshot, &renderPacer, &renderStats, drawTime, presentTime);
+            gameUnlockUi();
+        }
+        snapshots.release();
         
-        Uint32 elapsedTicks = SDL_GetTicks() - startTicks;
-        if (elapsedTicks < 1000.0 / FPS) {
-            SDL_Delay(static_cast<Uint32>(1000.0 / FPS - elapsedTicks));
+        Uint64 presentStart = SDL_GetPerformanceCounter();
+        {
+            PROFILE_ZONE("SDL_RenderPresent");
+            SDL_RenderPresent(renderer);
+        }
+        Uint64 presentEnd = SDL_GetPerformanceCounter();
+        
+        drawTime = (presentStart - drawStart) * 1000.0 / SDL_GetPerformanceFrequency();
+        presentTime = (presentEnd - presentStart) * 1000.0 / SDL_GetPerformanceFrequency();
+        takeStats(&renderStats);
+        
+        // the snapshot drawn has been handed back by now, so the report describes the latest one instead
+        if (frameWatchdog.isOverBudget(frameStart, presentEnd)) {
+            RenderSnapshot *latest = snapshots.acquire();
+            if (latest) {
+                FrameContext context;
+                getFrameContext(latest, &context);
+                frameWatchdog.report("render", frameStart, presentEnd, &context);
+            }
+            snapshots.release();
         }
+        
+        // the first frame with something on it, rather than the blank ones before the first snapshot
+        if (snapshot && !firstFrameShown) {
+            firstFrameShown = true;
+            if (printStartupStats) {
+                printStartup(initDone, gameInitDone, SDL_GetPerformanceCounter());
+            }
+        }
+        
+        renderPacer.endFrame();
+    }
+    
+    SDL_WaitThread(simulationThread, NULL);
+    
+    if (!traceFilename.empty()) {
+        dumpProfile(traceFilename, traceSeconds);
+    }
+    
+    if (printFrameStats) {
+        printPacerStats("simulation", &simulationPacer);
+        printPacerStats("render", &renderPacer);
+        printSimulationStats();
+    }
+    
+    // both threads have stopped, and nothing has been freed yet
+    if (printMemoryReport) {
+        if (levelMemory.getNumberOfSections() > 0) {
+            printf("levels played, as each was loaded\n");
+            printf("%s", levelMemory.format().c_str());
+        }
+        
+        printf("at exit\n");
+        
+        MemoryReport report;
+        gameReportMemory(&report);
+        snapshots.reportMemory(&report);
+        printf("%s", report.format().c_str());
     }
     
     cleanUp();
     return 0;
 }
 
+int simulate(void *) {
+    Uint8 keys[SDL_NUM_SCANCODES];
+    char letters[MAX_QUEUED_LETTERS];
+    
+    PROFILE_THREAD("simulation");
+    
+    while (SDL_AtomicGet(&running)) {
+        simulationPacer.beginFrame();
+        
+        // update
+        Uint64 updateStart = SDL_GetPerformanceCounter();
+        
+        int numLetters = inputQueue.take(keys, letters);
+        activeKeyboardLayout->update(keys);
+        
+        bool wasPlaying = gameIsPlayingLevelFile();
+        
+        if (!gameUpdate(activeKeyboardLayout, letters, numLetters)) {
+            SDL_AtomicSet(&running, 0);
+        }
+        
+        if (!recordFilename.empty()) {
+            updateRecording(wasPlaying);
+        }
+        
+        double updateTime = (SDL_GetPerformanceCounter() - updateStart) * 1000.0 / SDL_GetPerformanceFrequency();
+        
+        // publish what the renderer should draw; if it's still busy with the back buffer, it just sees this tick later.
+        // the counts keep adding up until a snapshot takes them
+        RenderSnapshot *snapshot = snapshots.beginWrite();
+        if (snapshot) {
+            gameSnapshot(snapshot);
+            
+            StatCounts stats;
+            takeStats(&stats);
+            snapshot->setSimulationStats(&stats, updateTime);
+            
+            addStats(&simulationTotals, &stats);
+            
+            snapshots.publish();
+        }
+        
+        // every tick, published or not; waiting on the renderer is one of the things that makes them slow
+        Uint64 updateEnd = SDL_GetPerformanceCounter();
+        if (frameWatchdog.isOverBudget(updateStart, updateEnd)) {
+            FrameContext context;
+            gameGetFrameContext(&context);
+            frameWatchdog.report("simulation", updateStart, updateEnd, &context);
+        }
+        
+        simulationTicks++;
+        simulationPacer.endFrame();
+    }
+    
+    // quitting mid-run still saves it
+    if (!recordFilename.empty() && gameIsPlayingLevelFile()) {
+        saveRecording();
+    }
+    
+    return 0;
+}
+
+// a run starts on the tick a level is picked and ends when it's left for the menu or the editor.
+// the tick that picked it isn't part of it; a replay starts the level itself
+void updateRecording(bool wasPlaying) {
+    bool playing = gameIsPlayingLevelFile();
+    
+    if (wasPlaying) {
+        recording.addTick(activeKeyboardLayout->getHeldButtons());
+        
+        if (!playing) {
+            saveRecording();
+        }
+    } else if (playing) {
+        recording.reset(gameGetLevelName());
+    }
+}
+
+void saveRecording() {
+    if (recording.save(recordFilename)) {
+        printf("recorded %d ticks of %s to %s\n", recording.getNumberOfTicks(), recording.getLevelName().c_str(), recordFilename.c_str());
+    }
+}
+
+void printPacerStats(string name, FramePacer *pacer) {
+    printf("%s frame times over the last %d frames: p50 %.3f ms, p99 %.3f ms, max %.3f ms\n", name.c_str(), pacer->getNumberOfSamples(), pacer->getP50(), pacer->getP99(), pacer->getMax());
+}
+
+void printSimulationStats() {
+#ifdef UMIHARA_NO_COUNTERS
+    printf("simulation counters: built without counters\n");
+#else
+    printf("simulation counters per tick over %llu ticks:", static_cast<unsigned long long>(simulationTicks));
+    for (int i = 0; i < NUMBER_OF_STAT_COUNTERS; i++) {
+        if (i != DRAW_CALLS) {
+            printf(" %s %.1f%s", STAT_COUNTER_STRINGS[i].c_str(), simulationTicks > 0 ? static_cast<double>(simulationTotals.counts[i]) / simulationTicks : 0.0, i + 1 < NUMBER_OF_STAT_COUNTERS ? "," : "\n");
+        }
+    }
+#endif
+}
+
 bool init() {
     if (SDL_Init(SDL_INIT_VIDEO) < 0) {
         printf("Couldn't initialize SDL. Error: %s\n", SDL_GetError());
         return false;
     }
     
+    if (!initProfiler()) {
+        return false;
+    }
+    
     if (TTF_Init() < 0) {
         printf("Couldn't initialize TTF. Error: %s\n", SDL_GetError());
         return false;
@@ -134,7 +440,12 @@ bool init() {
         return false;
     }
     
-    renderer = SDL_CreateRenderer(window, -1, SDL_RENDERER_ACCELERATED);
+    Uint32 rendererFlags = SDL_RENDERER_ACCELERATED;
+    if (vsync) {
+        rendererFlags |= SDL_RENDERER_PRESENTVSYNC;
+    }
+    
+    renderer = SDL_CreateRenderer(window, -1, rendererFlags);
     if (renderer == NULL) {
         printf("Couldn't create renderer. Error: %s\n", SDL_GetError());
         return false;
@@ -169,7 +480,9 @@ bool init() {
 }
 
 void cleanUp() {
+    frameWatchdog.stop();
     gameCleanUp();
+    closeProfiler();
     
     SDL_DestroyRenderer(renderer);
     SDL_DestroyWindow(window);
@@ -178,3 +491,69 @@ void cleanUp() {
     
     SDL_Quit();
 }
+
+void printStartup(Uint64 initDone, Uint64 gameInitDone, Uint64 firstFrame) {
+    double frequency = SDL_GetPerformanceFrequency() / 1000.0;
+    
+    printf("startup: SDL and window %.1f ms, game init %.1f ms, first frame %.1f ms, %.1f ms in total\n", (initDone - processStart) / frequency, (gameInitDone - initDone) / frequency, (firstFrame - gameInitDone) / frequency, (firstFrame - processStart) / frequency);
+}
+
+int buildLevelPack(string name) {
+    // every loose level in the levels directory
+    vector<string> levelNames;
+    
+    error_code error;
+    for (filesystem::directory_iterator i("levels", error); !error && i != filesystem::directory_iterator(); i.increment(error)) {
+        if (i->path().extension() == ".lvl") {
+            levelNames.push_back(i->path().filename().replace_extension("").string());
+        }
+    }
+    
+    return LevelPack::build("levels/" + name + PACK_EXTENSION, levelNames) ? 0 : -1;
+}
+
+int convertLevel(string name, char format) {
+    Level level;
+    if (!level.loadLevel(name)) {
+        return -1;
+    }
+    
+    // a chunked level isn't all in memory to write out again
+    if (level.isStreaming()) {
+        if (format == 'C') {
+            printf("levels/%s.lvl is already chunked\n", name.c_str());
+            return 0;
+        }
+        
+        printf("Couldn't convert level. Error: levels/%s.lvl is chunked, and only streamed in\n", name.c_str());
+        return -1;
+    }
+    
+    if (format == 'C') {
+        level.saveChunkedLevel(name, NULL);
+    } else {
+        level.saveRunLengthLevel(name, NULL);
+    }
+    
+    printf("converted levels/%s.lvl to \"%c\": %dx%d tiles, %d platforms\n", name.c_str(), format, level.getMaxX() / PLATFORM_WIDTH + 1, level.getMaxY() / PLATFORM_HEIGHT + 1, level.getNumberOfPlatforms());
+    return 0;
+}
+
+int generateLevel(string name, int numberOfSettings, char *settings[]) {
+    LevelGeneratorSettings generatorSettings;
+    setDefaultGeneratorSettings(&generatorSettings);
+    
+    for (int i = 0; i < numberOfSettings; i++) {
+        if (!parseGeneratorSetting(settings[i], &generatorSettings)) {
+            return -1;
+        }
+    }
+    
+    Uint64 start = SDL_GetPerformanceCounter();
+    if (!generateLevelFile(name, &generatorSettings)) {
+        return -1;
+    }
+    
+    printf("generated levels/%s.lvl: %dx%d tiles, seed %llu, in %.1f ms\n", name.c_str(), generatorSettings.width, generatorSettings.height, static_cast<unsigned long long>(generatorSettings.seed), (SDL_GetPerformanceCounter() - start) * 1000.0 / SDL_GetPerformanceFrequency());
+    return 0;
+}
@@ -0,0 +1,119 @@
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+
+#if defined __APPLE__ || defined __linux__
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
+#ifdef _WIN64
+#include <fstream>
+#endif
+
+#include "mappedfile.hpp"
+
+MappedFile::MappedFile() {
+    _data = NULL;
+    _size = 0;
+    
+    _mapped = false;
+}
+
+MappedFile::~MappedFile() {
+    close();
+}
+
+#if defined __APPLE__ || defined __linux__
+bool MappedFile::open(string filename) {
+    close();
+    
+    int fd = ::open(filename.c_str(), O_RDONLY);
+    if (fd < 0) {
+        return false;
+    }
+    
+    struct stat info;
+    if (fstat(fd, &info) != 0) {
+        printf("Couldn't read %s. Error: %s\n", filename.c_str(), strerror(errno));
+        ::close(fd);
+        return false;
+    }
+    
+    // mmap refuses empty files, which are fine to hand back as zero bytes
+    if (info.st_size == 0) {
+        ::close(fd);
+        return true;
+    }
+    
+    void *data = mmap(NULL, info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    
+    if (data == MAP_FAILED) {
+        printf("Couldn't map %s. Error: %s\n", filename.c_str(), strerror(errno));
+        return false;
+    }
+    
+    // levels are parsed front to back, so let the kernel read ahead aggressively
+    madvise(data, info.st_size, MADV_SEQUENTIAL);
+    
+    _data = static_cast<const char *>(data);
+    _size = info.st_size;
+    _mapped = true;
+    
+    return true;
+}
+
+void MappedFile::close() {
+    if (_mapped) {
+        munmap(const_cast<char *>(_data), _size);
+    }
+    
+    _data = NULL;
+    _size = 0;
+    _mapped = false;
+}
+#endif
+
+#ifdef _WIN64
+bool MappedFile::open(string filename) {
+    close();
+    
+    ifstream file(filename, ios_base::binary | ios_base::ate);
+    if (file.fail()) {
+        return false;
+    }
+    
+    _size = file.tellg();
+    file.seekg(0);
+    
+    char *data = new char[_size];
+    file.read(data, _size);
+    _data = data;
+    
+    if (file.fail()) {
+        printf("Couldn't read %s\n", filename.c_str());
+        close();
+        return false;
+    }
+    
+    return true;
+}
+
+void MappedFile::close() {
+    delete[] _data;
+    
+    _data = NULL;
+    _size = 0;
+}
+#endif
+
+const char *MappedFile::getData() {
+    return _data;
+}
+
+size_t MappedFile::getSize() {
+    return _size;
+}
@@ -0,0 +1,28 @@
+#ifndef mappedfile_hpp
+#define mappedfile_hpp
+
+#include <stddef.h>
+#include <string>
+using namespace std;
+
+// read-only view of a whole file. on macOS and linux the file is mmapped and paged in sequentially,
+// elsewhere it's read into memory in one go
+class MappedFile {
+public:
+    MappedFile();
+    ~MappedFile();
+    
+    bool open(string filename);
+    void close();
+    
+    const char *getData();
+    size_t getSize();
+    
+private:
+    const char *_data;
+    size_t _size;
+    
+    bool _mapped;
+};
+
+#endif
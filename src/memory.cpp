@@ -0,0 +1,120 @@
+#include <stdio.h>
+
+#include "memory.hpp"
+
+void MemoryReport::beginSection(string name) {
+    MemorySection section;
+    section.name = name;
+    
+    for (int i = 0; i < NUMBER_OF_MEMORY_SUBSYSTEMS; i++) {
+        section.usage[i].used = 0;
+        section.usage[i].allocated = 0;
+        section.usage[i].blocks = 0;
+    }
+    
+    _sections.push_back(section);
+}
+
+void MemoryReport::add(int subsystem, size_t used, size_t allocated) {
+    add(subsystem, used, allocated, 1);
+}
+
+void MemoryReport::add(int subsystem, size_t used, size_t allocated, int blocks) {
+    if (_sections.empty()) {
+        beginSection("other");
+    }
+    
+    MemoryUsage *usage = _sections.back().usage + subsystem;
+    usage->used += used;
+    usage->allocated += allocated;
+    usage->blocks += blocks;
+}
+
+int MemoryReport::getNumberOfSections() {
+    return static_cast<int>(_sections.size());
+}
+
+MemorySection *MemoryReport::getSection(int i) {
+    return &_sections[i];
+}
+
+size_t MemoryReport::getTotalUsed() {
+    size_t total = 0;
+    for (size_t i = 0; i < _sections.size(); i++) {
+        for (int j = 0; j < NUMBER_OF_MEMORY_SUBSYSTEMS; j++) {
+            total += _sections[i].usage[j].used;
+        }
+    }
+    
+    return total;
+}
+
+size_t MemoryReport::getTotalAllocated() {
+    size_t total = 0;
+    for (size_t i = 0; i < _sections.size(); i++) {
+        for (int j = 0; j < NUMBER_OF_MEMORY_SUBSYSTEMS; j++) {
+            total += _sections[i].usage[j].allocated;
+        }
+    }
+    
+    return total;
+}
+
+string formatBytes(size_t bytes) {
+    char text[32];
+    
+    if (bytes < 1024) {
+        snprintf(text, sizeof(text), "%zu B", bytes);
+    } else if (bytes < 1024 * 1024) {
+        snprintf(text, sizeof(text), "%.1f KB", bytes / 1024.0);
+    } else {
+        snprintf(text, sizeof(text), "%.1f MB", bytes / (1024.0 * 1024.0));
+    }
+    
+    return text;
+}
+
+string MemoryReport::format() {
+    char line[256];
+    string report;
+    
+    size_t allocated = getTotalAllocated();
+    snprintf(line, sizeof(line), "memory: %s allocated, %s of it unused capacity\n", formatBytes(allocated).c_str(), formatBytes(allocated - getTotalUsed()).c_str());
+    report += line;
+    
+    for (size_t i = 0; i < _sections.size(); i++) {
+        report += "    " + _sections[i].name + ":";
+        
+        bool empty = true;
+        for (int j = 0; j < NUMBER_OF_MEMORY_SUBSYSTEMS; j++) {
+            MemoryUsage *usage = _sections[i].usage + j;
+            if (usage->blocks == 0) {
+                continue;
+            }
+            
+            if (usage->allocated > usage->used) {
+                snprintf(line, sizeof(line), "\n        %-16s %10s in %d block%s, %s unused", MEMORY_SUBSYSTEM_STRINGS[j].c_str(), formatBytes(usage->allocated).c_str(), usage->blocks, usage->blocks == 1 ? "" : "s", formatBytes(usage->allocated - usage->used).c_str());
+            } else {
+                snprintf(line, sizeof(line), "\n        %-16s %10s in %d block%s", MEMORY_SUBSYSTEM_STRINGS[j].c_str(), formatBytes(usage->allocated).c_str(), usage->blocks, usage->blocks == 1 ? "" : "s");
+            }
+            report += line;
+            empty = false;
+        }
+        
+        report += empty ? " nothing\n" : "\n";
+    }
+    
+    return report;
+}
+
+size_t getTextureBytes(SDL_Texture *texture) {
+    Uint32 format = 0;
+    int width = 0;
+    int height = 0;
+    
+    if (!texture || SDL_QueryTexture(texture, &format, NULL, &width, &height) != 0) {
+        return 0;
+    }
+    
+    return static_cast<size_t>(width) * height * SDL_BYTESPERPIXEL(format);
+}
@@ -0,0 +1,80 @@
+#ifndef memory_hpp
+#define memory_hpp
+
+#if defined __APPLE__ || defined __linux__
+#include <SDL2/SDL.h>
+#endif
+
+#ifdef _WIN64
+#include <SDL.h>
+#endif
+
+#include <string>
+#include <vector>
+using namespace std;
+
+enum MemorySubsystem {
+    PLATFORM_STORAGE,
+    TILE_INDEX,         // Level's platformExists grid
+    STREAMED_CHUNKS,    // resident chunks of a "C" level and the table over them
+    ROPE_PIVOTS,
+    SEEKER_PIVOTS,
+    SNAPSHOT_PIVOTS,    // the flattened copies of the rope handed to the renderer
+    TEXT_TEXTURES,
+    FONTS,
+    SDL_TEXTURES,       // every other texture
+    
+    NUMBER_OF_MEMORY_SUBSYSTEMS
+};
+
+const string MEMORY_SUBSYSTEM_STRINGS[NUMBER_OF_MEMORY_SUBSYSTEMS] = {
+    "platforms",
+    "tile index",
+    "streamed chunks",
+    "rope pivots",
+    "seeker pivots",
+    "snapshot pivots",
+    "text textures",
+    "fonts",
+    "textures"
+};
+
+// what one subsystem holds. allocated is used plus capacity that's been grown into and not used (yet).
+// textures are counted at their pixel size, although the driver may keep them in video memory
+struct MemoryUsage {
+    size_t used;
+    size_t allocated;
+    int blocks;
+};
+
+// everything one owner holds: a level, the player, the text
+struct MemorySection {
+    string name;
+    MemoryUsage usage[NUMBER_OF_MEMORY_SUBSYSTEMS];
+};
+
+// what the game's biggest structures hold, by owner and subsystem. the owners fill it in with their
+// reportMemory methods, which read state belonging to the simulation and render threads, so a report
+// is only taken while neither is running
+class MemoryReport {
+public:
+    // everything added until the next section goes into this one
+    void beginSection(string name);
+    void add(int subsystem, size_t used, size_t allocated);
+    void add(int subsystem, size_t used, size_t allocated, int blocks);
+    
+    int getNumberOfSections();
+    MemorySection *getSection(int i);
+    
+    size_t getTotalUsed();
+    size_t getTotalAllocated();
+    
+    string format();
+    
+private:
+    vector<MemorySection> _sections;
+};
+
+size_t getTextureBytes(SDL_Texture *texture);
+
+#endif
@@ -0,0 +1,135 @@
+#include <algorithm>
+
+#include "overlay.hpp"
+#include "allocations.hpp"
+using namespace std;
+
+PerformanceOverlay::PerformanceOverlay() {
+    _visible = false;
+    
+    _framesSinceRefresh = 0;
+    _updateTimeTotal = 0;
+    _drawTimeTotal = 0;
+    _presentTimeTotal = 0;
+    
+    _background.setWidth(OVERLAY_WIDTH);
+    _background.setHeight(OVERLAY_MARGIN * 3 + OVERLAY_GRAPH_HEIGHT + NUMBER_OF_OVERLAY_LINES * OVERLAY_LINE_HEIGHT);
+    _background.setColor(0x00, 0x00, 0x00, 0xC0);
+    
+    for (int i = 0; i < NUMBER_OF_OVERLAY_LINES; i++) {
+        _lines[i].initFont(OVERLAY_TEXT_SIZE);
+        _lines[i].setColor(0xFF, 0xFF, 0xFF, 0xFF);
+        _lines[i].setText(" ");
+    }
+}
+
+void PerformanceOverlay::toggle() {
+    _visible = !_visible;
+    
+    // refresh on the first frame shown instead of leaving old numbers up for a while
+    _framesSinceRefresh = OVERLAY_REFRESH_FRAMES - 1;
+    _updateTimeTotal = 0;
+    _drawTimeTotal = 0;
+    _presentTimeTotal = 0;
+}
+
+bool PerformanceOverlay::isVisible() {
+    return _visible;
+}
+
+void PerformanceOverlay::draw(SDL_Renderer *renderer, RenderSnapshot *snapshot, FramePacer *renderPacer, StatCounts *renderStats, double drawTime, double presentTime) {
+    if (!_visible) {
+        return;
+    }
+    
+    _framesSinceRefresh++;
+    _updateTimeTotal += snapshot->getUpdateTime();
+    _drawTimeTotal += drawTime;
+    _presentTimeTotal += presentTime;
+    
+    if (_framesSinceRefresh >= OVERLAY_REFRESH_FRAMES) {
+        refreshText(snapshot, renderPacer, renderStats);
+    }
+    
+    // top right, out of the way of the timer
+    int width, height;
+    SDL_GetRendererOutputSize(renderer, &width, &height);
+    
+    int x = width - OVERLAY_WIDTH - OVERLAY_MARGIN;
+    int y = OVERLAY_MARGIN;
+    
+    _background.setX(x);
+    _background.setY(y);
+    _background.draw(renderer);
+    
+    drawGraph(renderer, renderPacer, x + OVERLAY_MARGIN, y + OVERLAY_MARGIN);
+    
+    int textY = y + OVERLAY_MARGIN * 2 + OVERLAY_GRAPH_HEIGHT;
+    for (int i = 0; i < NUMBER_OF_OVERLAY_LINES; i++) {
+        _lines[i].draw(renderer, x + OVERLAY_MARGIN, textY + i * OVERLAY_LINE_HEIGHT);
+    }
+}
+
+void PerformanceOverlay::refreshText(RenderSnapshot *snapshot, FramePacer *renderPacer, StatCounts *renderStats) {
+    int *simulation = snapshot->getSimulationStats()->counts;
+    int *render = renderStats->counts;
+    char line[128];
+    
+    snprintf(line, sizeof(line), "frame %.1f ms   p50 %.1f   p99 %.1f   max %.1f", renderPacer->getLastFrameTime(), renderPacer->getP50(), renderPacer->getP99(), renderPacer->getMax());
+    _lines[0].setText(line);
+    
+    snprintf(line, sizeof(line), "sim %.2f ms   render %.2f ms   present %.2f ms", _updateTimeTotal / _framesSinceRefresh, _drawTimeTotal / _framesSinceRefresh, _presentTimeTotal / _framesSinceRefresh);
+    _lines[1].setText(line);
+    
+    snprintf(line, sizeof(line), "draw calls %d", render[DRAW_CALLS]);
+    _lines[2].setText(line);
+    
+    int scans = simulation[PLATFORM_SCANS];
+    snprintf(line, sizeof(line), "platform scans %d   platforms per scan %d", scans, scans > 0 ? simulation[PLATFORMS_TESTED] / scans : 0);
+    _lines[3].setText(line);
+    
+    snprintf(line, sizeof(line), "line-rect tests %d   player checks %d", simulation[LINE_RECT_TESTS], simulation[PLAYER_COLLISION_CHECKS]);
+    _lines[4].setText(line);
+    
+    snprintf(line, sizeof(line), "rope pivots %d   +%d -%d   seeker steps %d", snapshot->getGrapple()->getNumberOfPivots(), simulation[PIVOTS_ADDED], simulation[PIVOTS_REMOVED], simulation[SEEKER_STEPS]);
+    _lines[5].setText(line);
+    
+    if (isTrackingAllocations()) {
+        snprintf(line, sizeof(line), "allocations   sim %d (%d B)   render %d (%d B)", simulation[ALLOCATIONS], simulation[ALLOCATED_BYTES], render[ALLOCATIONS], render[ALLOCATED_BYTES]);
+    } else {
+        snprintf(line, sizeof(line), "allocations not tracked in this build");
+    }
+    _lines[6].setText(line);
+    
+    _framesSinceRefresh = 0;
+    _updateTimeTotal = 0;
+    _drawTimeTotal = 0;
+    _presentTimeTotal = 0;
+}
+
+void PerformanceOverlay::drawGraph(SDL_Renderer *renderer, FramePacer *renderPacer, int x, int y) {
+    int graphWidth = OVERLAY_WIDTH - OVERLAY_MARGIN * 2;
+    
+    // the target frame time is halfway up; anything slower than twice that is cut off at the top
+    double budget = renderPacer->getTargetFrameTime();
+    double scale = OVERLAY_GRAPH_HEIGHT / (budget * 2);
+    
+    SDL_SetRenderDrawColor(renderer, 0xFF, 0xFF, 0x00, 0x80);
+    SDL_RenderDrawLine(renderer, x, y + OVERLAY_GRAPH_HEIGHT / 2, x + graphWidth, y + OVERLAY_GRAPH_HEIGHT / 2);
+    COUNT_STAT(DRAW_CALLS, 1);
+    
+    // oldest frame on the left, the whole graph as one draw call
+    int numberOfSamples = renderPacer->getNumberOfSamples();
+    for (int i = 0; i < numberOfSamples; i++) {
+        double frameTime = min(renderPacer->getFrameTime(numberOfSamples - 1 - i), budget * 2);
+        
+        _graph[i].x = x + i * graphWidth / FRAME_TIME_SAMPLES;
+        _graph[i].y = y + OVERLAY_GRAPH_HEIGHT - static_cast<int>(frameTime * scale);
+    }
+    
+    if (numberOfSamples > 1) {
+        SDL_SetRenderDrawColor(renderer, 0x00, 0xFF, 0x00, 0xFF);
+        SDL_RenderDrawLines(renderer, _graph, numberOfSamples);
+        COUNT_STAT(DRAW_CALLS, 1);
+    }
+}
@@ -0,0 +1,60 @@
+#ifndef overlay_hpp
+#define overlay_hpp
+
+#if defined __APPLE__ || defined __linux__
+#include <SDL2/SDL.h>
+#endif
+
+#ifdef _WIN64
+#include <SDL.h>
+#endif
+
+#include "text.hpp"
+#include "timing.hpp"
+#include "snapshot.hpp"
+#include "stats.hpp"
+
+const int OVERLAY_WIDTH = 320;
+const int OVERLAY_MARGIN = 5;
+const int OVERLAY_GRAPH_HEIGHT = 60;
+
+const int OVERLAY_TEXT_SIZE = 14;
+const int OVERLAY_LINE_HEIGHT = 17;
+const int NUMBER_OF_OVERLAY_LINES = 7;
+
+// the text is only rendered again this often, so the overlay isn't redoing TTF work every frame.
+// the graph is redrawn every frame
+const int OVERLAY_REFRESH_FRAMES = 15;
+
+// frame time graph, where the time goes and the engine's counters, drawn over the game. everything on
+// it is timed or counted by the engine anyway; the overlay only shows it
+class PerformanceOverlay {
+public:
+    PerformanceOverlay();
+    
+    void toggle();
+    bool isVisible();
+    
+    // renderStats, drawTime and presentTime are for the last whole frame (the overlay's own draw
+    // calls included), the simulation's numbers for the tick behind the snapshot
+    void draw(SDL_Renderer *renderer, RenderSnapshot *snapshot, FramePacer *renderPacer, StatCounts *renderStats, double drawTime, double presentTime);
+    
+private:
+    void refreshText(RenderSnapshot *snapshot, FramePacer *renderPacer, StatCounts *renderStats);
+    void drawGraph(SDL_Renderer *renderer, FramePacer *renderPacer, int x, int y);
+    
+    bool _visible;
+    
+    // times added up since the text was last refreshed, so it shows averages rather than one frame
+    int _framesSinceRefresh;
+    double _updateTimeTotal;
+    double _drawTimeTotal;
+    double _presentTimeTotal;
+    
+    ColorBlock _background;
+    TextBox _lines[NUMBER_OF_OVERLAY_LINES];
+    
+    SDL_Point _graph[FRAME_TIME_SAMPLES];
+};
+
+#endif
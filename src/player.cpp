@@ -1,4 +1,6 @@
 #include "player.hpp"
+#include "profiler.hpp"
+#include "stats.hpp"
 
 #ifdef _WIN64
 #define M_PI_2 M_PI/2
@@ -9,20 +11,23 @@ const int DEATH_MARGIN = 100;
 
 Player::Player() {
     _x = 0;
-    _x = 0;
+    _y = 0;
     _width = PLATFORM_WIDTH;
     _height = PLATFORM_HEIGHT;
     
-    _grappleSeeker = NULL;
-    _rope = NULL;
-    
-    _grounded = false;
-    _facing = RIGHT;
+    reset();
     
-    _canAirBlast = false;
+    // both measure from the player, so they come after it has a position
+    _seekerSlot = new GrappleSeeker(this, 0);
+    _ropeSlot = new Rope(this, 0, 0);
     
-    _wasCollidingVertically = false;
-    _wasCollidingHorizontally = false;
+    _grappleSeeker = NULL;
+    _rope = NULL;
+}
+
+Player::~Player() {
+    delete _seekerSlot;
+    delete _ropeSlot;
 }
 
 double Player::getX() {
@@ -59,21 +64,36 @@ void Player::stop() {
     _velocityY = 0;
 }
 
+void Player::reset() {
+    stop();
+    
+    // the platform may belong to a level that's since been unloaded
+    _grounded = false;
+    _groundedPlatform = NULL;
+    _aim = -1;
+    _facing = RIGHT;
+    
+    _canAirBlast = false;
+    
+    _wasCollidingVertically = false;
+    _wasCollidingHorizontally = false;
+}
+
 void Player::createGrappleSeeker(double angle) {
-    _grappleSeeker = new GrappleSeeker(this, angle);
+    _seekerSlot->reset(angle);
+    _grappleSeeker = _seekerSlot;
 }
 
 void Player::destroyGrappleSeeker() {
-    delete _grappleSeeker;
     _grappleSeeker = NULL;
 }
 
 void Player::createRope(int gX, int gY) {
-    _rope = new Rope(this, gX, gY);
+    _ropeSlot->reset(gX, gY);
+    _rope = _ropeSlot;
 }
 
 void Player::destroyRope() {
-    delete _rope;
     _rope = NULL;
 }
 
@@ -93,6 +113,16 @@ Rope *Player::getRope() {
     return _rope;
 }
 
+int Player::getNumberOfPivots() {
+    if (_rope) {
+        return _rope->getPivots()->getNumberOfPivots();
+    } else if (_grappleSeeker) {
+        return _grappleSeeker->getNumberOfPivots();
+    }
+    
+    return 0;
+}
+
 bool rectsOverlap(double x1, double y1, int w1, int h1, double x2, double y2, int w2, int h2) {
     if (x1 > x2 - w1 && x1 < x2 + w2 &&   // aligned x
         y1 > y2 - h1 && y1 < y2 + h2) {   // aligned y
@@ -123,6 +153,8 @@ int Player::checkCollision(Platform *p) {
 }
 
 bool Player::update(KeyboardLayout *keys, Level *level) {
+    PROFILE_ZONE("Player::update");
+    
     _velocityY += GRAVITY;
     
     // fire direction (aim)
@@ -263,11 +295,17 @@ bool Player::update(KeyboardLayout *keys, Level *level) {
         _velocityY = -MAX_VELOCITY_Y;
     }
     
+    // velocity is capped well below a tile, so a tile around the player covers this move
+    level->requireArea(_x - PLATFORM_WIDTH, _y - PLATFORM_HEIGHT, _width + PLATFORM_WIDTH * 2, _height + PLATFORM_HEIGHT * 2);
+    
     int collision = -1;
     _grounded = false;
+    COUNT_STAT(PLATFORM_SCANS, 1);
+    COUNT_STAT(PLATFORMS_TESTED, level->getNumberOfPlatforms());
     for (int i = 0; i < level->getNumberOfPlatforms(); i++) {
         collision = checkCollision(level->getPlatform(i));
         if (collision >= 0 && level->getPlatform(i)->getType() == LAVA) {
+            COUNT_STAT(PLAYER_COLLISION_CHECKS, i + 1);
             return false;
         }
         
@@ -295,6 +333,9 @@ bool Player::update(KeyboardLayout *keys, Level *level) {
         }
     }
     
+    // counted once here rather than on every platform
+    COUNT_STAT(PLAYER_COLLISION_CHECKS, level->getNumberOfPlatforms());
+    
     _x += _velocityX;
     _y += _velocityY;
     
@@ -362,72 +403,25 @@ bool Player::update(KeyboardLayout *keys, Level *level) {
     return true;
 }
 
-void Player::draw(SDL_Renderer *renderer, double cameraX, double cameraY) {
+void Player::snapshot(PlayerSnapshot *player, GrappleSnapshot *grapple) {
+    player->x = _x;
+    player->y = _y;
+    player->width = _width;
+    player->height = _height;
+    player->velocityX = _velocityX;
+    player->velocityY = _velocityY;
+    player->aim = _aim;
+    player->facing = _facing;
+    
+    grapple->clear();
     if (_rope) {
-        _rope->draw(renderer, cameraX, cameraY);
+        _rope->snapshot(grapple);
     } else if (_grappleSeeker) {
-        _grappleSeeker->draw(renderer, cameraX, cameraY);
+        _grappleSeeker->snapshot(grapple);
     }
-    
-    SDL_SetRenderDrawColor(renderer, 0xFF, 0x00, 0x00, 0xFF);
-    
-    SDL_Rect rect = { static_cast<int>(_x - cameraX), static_cast<int>(_y - cameraY), _width, _height };
-    SDL_RenderFillRect(renderer, &rect);
-    
-    // eyes whites
-    SDL_SetRenderDrawColor(renderer, 0xFF, 0xFF, 0xFF, 0xFF);
-    
-    SDL_Rect leftWhiteRect = { static_cast<int>(_x - cameraX) + LEFT_EYE_POS, static_cast<int>(_y - cameraY) + EYE_HEIGHT, EYE_WIDTH, EYE_WIDTH };
-    SDL_RenderFillRect(renderer, &leftWhiteRect);
-    
-    SDL_Rect rightWhiteRect = { static_cast<int>(_x - cameraX) + RIGHT_EYE_POS, static_cast<int>(_y - cameraY) + EYE_HEIGHT, EYE_WIDTH, EYE_WIDTH };
-    SDL_RenderFillRect(renderer, &rightWhiteRect);
-    
-    // pupils
-    SDL_SetRenderDrawColor(renderer, 0x00, 0x00, 0x00, 0xFF);
-    
-    int lookXOffset = 0;
-    int lookYOffset = 0;
-    
-    switch (_aim) {
-        case UPLEFT:
-            lookXOffset -= LOOK_DISTANCE;
-            lookYOffset -= LOOK_DISTANCE;
-            break;
-        case UP:
-            lookYOffset -= LOOK_DISTANCE;
-            break;
-        case UPRIGHT:
-            lookXOffset += LOOK_DISTANCE;
-            lookYOffset -= LOOK_DISTANCE;
-            break;
-        case DOWNLEFT:
-            lookXOffset -= LOOK_DISTANCE;
-            lookYOffset += LOOK_DISTANCE;
-            break;
-        case DOWN:
-            lookYOffset += LOOK_DISTANCE;
-            break;
-        case DOWNRIGHT:
-            lookXOffset += LOOK_DISTANCE;
-            lookYOffset += LOOK_DISTANCE;
-            break;
-        default:
-            if (_facing == LEFT) {
-                lookXOffset -= LOOK_DISTANCE;
-            } else if (_facing == RIGHT) {
-                lookXOffset += LOOK_DISTANCE;
-            }
-            break;
-    }
-    
-    SDL_Rect leftPupilRect = { leftWhiteRect.x + EYE_WIDTH / 2 - PUPIL_WIDTH / 2 + lookXOffset, leftWhiteRect.y + EYE_WIDTH / 2 - PUPIL_WIDTH / 2 + lookYOffset, PUPIL_WIDTH, PUPIL_WIDTH };
-    SDL_Rect rightPupilRect = { rightWhiteRect.x + EYE_WIDTH / 2 - PUPIL_WIDTH / 2 + lookXOffset, rightWhiteRect.y + EYE_WIDTH / 2 - PUPIL_WIDTH / 2 + lookYOffset, PUPIL_WIDTH, PUPIL_WIDTH };
-    
-    SDL_RenderFillRect(renderer, &leftPupilRect);
-    SDL_RenderFillRect(renderer, &rightPupilRect);
 }
 
-void Player::draw(SDL_Renderer *renderer) {
-    draw(renderer, 0, 0);
+void Player::reportMemory(MemoryReport *report) {
+    _ropeSlot->reportMemory(report);
+    _seekerSlot->reportMemory(report);
 }
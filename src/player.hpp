@@ -10,6 +10,7 @@
 #endif
 
 #include "level.hpp"
+#include "snapshot.hpp"
 #include "grapple.hpp"
 #include "controls.hpp"
 
@@ -55,6 +56,7 @@ enum Direction {
 class Player {
 public:
     Player();
+    ~Player();
     
     double getX();
     double getY();
@@ -66,6 +68,9 @@ public:
     void setPos(double x, double y);
     void stop();
     
+    // stopped and standing nowhere, as a new player starts, so every attempt at a level plays out the same
+    void reset();
+    
     void createGrappleSeeker(double angle);
     void destroyGrappleSeeker();
     
@@ -78,10 +83,15 @@ public:
     
     Rope *getRope();
     
+    // the rope's, or the seeker's while it's out
+    int getNumberOfPivots();
+    
     bool update(KeyboardLayout *keys, Level *level);
     
-    void draw(SDL_Renderer *renderer);
-    void draw(SDL_Renderer *renderer, double cameraX, double cameraY);
+    void snapshot(PlayerSnapshot *player, GrappleSnapshot *grapple);
+    
+    // the rope and seeker kept for grappling, whether they're out or not
+    void reportMemory(MemoryReport *report);
     
     int checkCollision(Platform *p);
     
@@ -105,8 +115,13 @@ private:
     bool _wasCollidingVertically;
     bool _wasCollidingHorizontally;
     
+    // whichever is out, or NULL. they're the slots below, which last as long as the player
+    // so grappling doesn't allocate
     GrappleSeeker *_grappleSeeker;
     Rope *_rope;
+    
+    GrappleSeeker *_seekerSlot;
+    Rope *_ropeSlot;
 };
 
 bool rectsOverlap(double x1, double y1, int w1, int h1, double x2, double y2, int w2, int h2);
@@ -0,0 +1,202 @@
+#include <algorithm>
+#include <stdio.h>
+
+#include "profiler.hpp"
+#include "filewriter.hpp"
+
+#ifdef UMIHARA_PROFILING
+
+// a ring of the last PROFILE_BUFFER_SIZE zones one thread recorded. only that thread writes to it,
+// so the only synchronisation is publishing the count after each event is filled in
+struct ProfileBuffer {
+    ProfileEvent events[PROFILE_BUFFER_SIZE];
+    SDL_atomic_t written;
+    int thread;
+    const char *name;
+};
+
+SDL_mutex *profilerMutex = NULL;
+ProfileBuffer *profileBuffers[MAX_PROFILED_THREADS];
+int numberOfProfileBuffers = 0;
+Uint64 profileStart = 0;
+
+thread_local ProfileBuffer *threadProfileBuffer = NULL;
+
+ProfileBuffer *getThreadProfileBuffer() {
+    if (threadProfileBuffer || !profilerMutex) {
+        return threadProfileBuffer;
+    }
+    
+    SDL_LockMutex(profilerMutex);
+    
+    if (numberOfProfileBuffers < MAX_PROFILED_THREADS) {
+        threadProfileBuffer = new ProfileBuffer();
+        SDL_AtomicSet(&threadProfileBuffer->written, 0);
+        threadProfileBuffer->thread = numberOfProfileBuffers + 1;
+        threadProfileBuffer->name = NULL;
+        
+        profileBuffers[numberOfProfileBuffers] = threadProfileBuffer;
+        numberOfProfileBuffers++;
+    }
+    
+    SDL_UnlockMutex(profilerMutex);
+    
+    return threadProfileBuffer;
+}
+
+void recordProfileZone(const char *name, Uint64 start, Uint64 end, Uint64 allocations, Uint64 bytes) {
+    ProfileBuffer *buffer = getThreadProfileBuffer();
+    if (!buffer) {
+        return;
+    }
+    
+    int written = SDL_AtomicGet(&buffer->written);
+    
+    ProfileEvent *event = buffer->events + (written & (PROFILE_BUFFER_SIZE - 1));
+    event->name = name;
+    event->start = start;
+    event->end = end;
+    event->thread = buffer->thread;
+    event->allocations = static_cast<Uint32>(allocations);
+    event->bytes = static_cast<Uint32>(bytes);
+    
+    SDL_AtomicSet(&buffer->written, written + 1);
+}
+
+bool initProfiler() {
+    profilerMutex = SDL_CreateMutex();
+    if (profilerMutex == NULL) {
+        printf("Couldn't create profiler mutex. Error: %s\n", SDL_GetError());
+        return false;
+    }
+    
+    profileStart = SDL_GetPerformanceCounter();
+    
+    return true;
+}
+
+void closeProfiler() {
+    for (int i = 0; i < numberOfProfileBuffers; i++) {
+        delete profileBuffers[i];
+    }
+    numberOfProfileBuffers = 0;
+    
+    if (profilerMutex) {
+        SDL_DestroyMutex(profilerMutex);
+        profilerMutex = NULL;
+    }
+}
+
+void setProfileThreadName(const char *name) {
+    ProfileBuffer *buffer = getThreadProfileBuffer();
+    if (buffer) {
+        buffer->name = name;
+    }
+}
+
+void collectProfileEvents(Uint64 since, vector<ProfileEvent> *events) {
+    if (!profilerMutex) {
+        return;
+    }
+    
+    SDL_LockMutex(profilerMutex);
+    
+    for (int i = 0; i < numberOfProfileBuffers; i++) {
+        ProfileBuffer *buffer = profileBuffers[i];
+        
+        int written = SDL_AtomicGet(&buffer->written);
+        
+        // zones are recorded as they end, so each buffer is in end order and the scan can stop at since.
+        // the slot the thread fills next still holds the oldest zone, which may be half overwritten already
+        int first = written;
+        while (first > 0 && first > written - PROFILE_BUFFER_SIZE + 1 && buffer->events[(first - 1) & (PROFILE_BUFFER_SIZE - 1)].end >= since) {
+            first--;
+        }
+        
+        size_t copied = events->size();
+        for (int j = first; j < written; j++) {
+            events->push_back(buffer->events[j & (PROFILE_BUFFER_SIZE - 1)]);
+        }
+        
+        // the thread kept recording while we copied; drop anything it may have lapped and overwritten
+        int overwritten = SDL_AtomicGet(&buffer->written) - PROFILE_BUFFER_SIZE + 1;
+        if (overwritten > first) {
+            events->erase(events->begin() + copied, events->begin() + copied + min(overwritten, written) - first);
+        }
+    }
+    
+    SDL_UnlockMutex(profilerMutex);
+}
+
+bool dumpProfile(string filename, double seconds) {
+    Uint64 frequency = SDL_GetPerformanceFrequency();
+    Uint64 now = SDL_GetPerformanceCounter();
+    Uint64 window = static_cast<Uint64>(seconds * frequency);
+    
+    vector<ProfileEvent> events;
+    collectProfileEvents(now > window ? now - window : 0, &events);
+    
+    string json = "{\"traceEvents\":[\n";
+    char line[256];
+    
+    SDL_LockMutex(profilerMutex);
+    for (int i = 0; i < numberOfProfileBuffers; i++) {
+        const char *name = profileBuffers[i]->name ? profileBuffers[i]->name : "thread";
+        snprintf(line, sizeof(line), "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%d,\"args\":{\"name\":\"%s\"}},\n", profileBuffers[i]->thread, name);
+        json += line;
+    }
+    SDL_UnlockMutex(profilerMutex);
+    
+    // complete events, in microseconds since the profiler started
+    for (size_t i = 0; i < events.size(); i++) {
+        double start = (events[i].start - profileStart) * 1000000.0 / frequency;
+        double duration = (events[i].end - events[i].start) * 1000000.0 / frequency;
+        
+        if (isTrackingAllocations()) {
+            snprintf(line, sizeof(line), "{\"name\":\"%s\",\"ph\":\"X\",\"pid\":1,\"tid\":%d,\"ts\":%.3f,\"dur\":%.3f,\"args\":{\"allocations\":%u,\"bytes\":%u}},\n", events[i].name, events[i].thread, start, duration, events[i].allocations, events[i].bytes);
+        } else {
+            snprintf(line, sizeof(line), "{\"name\":\"%s\",\"ph\":\"X\",\"pid\":1,\"tid\":%d,\"ts\":%.3f,\"dur\":%.3f},\n", events[i].name, events[i].thread, start, duration);
+        }
+        json += line;
+    }
+    
+    // no comma after the last event
+    if (json.compare(json.size() - 2, 2, ",\n") == 0) {
+        json.erase(json.size() - 2);
+    }
+    json += "\n],\"displayTimeUnit\":\"ms\"}\n";
+    
+    if (!writeFileAtomically(filename, json)) {
+        return false;
+    }
+    
+    printf("wrote %zu profiling zones from the last %.0f seconds to %s\n", events.size(), seconds, filename.c_str());
+    return true;
+}
+
+#else
+
+// zones are compiled out, so there's nothing to record or collect
+
+void recordProfileZone(const char *, Uint64, Uint64, Uint64, Uint64) {
+}
+
+bool initProfiler() {
+    return true;
+}
+
+void closeProfiler() {
+}
+
+void setProfileThreadName(const char *) {
+}
+
+void collectProfileEvents(Uint64, vector<ProfileEvent> *) {
+}
+
+bool dumpProfile(string filename, double) {
+    printf("Couldn't write %s. Error: built without UMIHARA_PROFILING\n", filename.c_str());
+    return false;
+}
+
+#endif
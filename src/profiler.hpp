@@ -0,0 +1,87 @@
+#ifndef profiler_hpp
+#define profiler_hpp
+
+#if defined __APPLE__ || defined __linux__
+#include <SDL2/SDL.h>
+#endif
+
+#ifdef _WIN64
+#include <SDL.h>
+#endif
+
+#include <string>
+#include <vector>
+using namespace std;
+
+#include "allocations.hpp"
+
+// zones are only recorded when the game is built with UMIHARA_PROFILING (cmake -DUMIHARA_PROFILING=ON).
+// otherwise PROFILE_ZONE and PROFILE_THREAD expand to nothing and the functions below do nothing
+
+const int PROFILE_BUFFER_SIZE = 1 << 16;    // zones kept per thread, a power of two
+const int MAX_PROFILED_THREADS = 8;
+
+const string TRACE_FILENAME = "trace.json";
+const double DEFAULT_TRACE_SECONDS = 10;
+
+struct ProfileEvent {
+    const char *name;   // always a string literal
+    Uint64 start;       // performance counter values
+    Uint64 end;
+    int thread;
+    
+    // made inside the zone, nested zones included. always 0 without UMIHARA_TRACK_ALLOCATIONS
+    Uint32 allocations;
+    Uint32 bytes;
+};
+
+void recordProfileZone(const char *name, Uint64 start, Uint64 end, Uint64 allocations, Uint64 bytes);
+
+#ifdef UMIHARA_PROFILING
+
+// times the rest of the enclosing scope
+class ProfileZone {
+public:
+    ProfileZone(const char *name) {
+        _name = name;
+        _allocations = getThreadAllocations();
+        _bytes = getThreadAllocatedBytes();
+        _start = SDL_GetPerformanceCounter();
+    }
+    
+    ~ProfileZone() {
+        recordProfileZone(_name, _start, SDL_GetPerformanceCounter(), getThreadAllocations() - _allocations, getThreadAllocatedBytes() - _bytes);
+    }
+    
+private:
+    const char *_name;
+    Uint64 _start;
+    Uint64 _allocations;
+    Uint64 _bytes;
+};
+
+#define PROFILE_ZONE_VARIABLE(line) profileZone##line
+#define PROFILE_ZONE_AT(name, line) ProfileZone PROFILE_ZONE_VARIABLE(line)(name)
+#define PROFILE_ZONE(name) PROFILE_ZONE_AT(name, __LINE__)
+#define PROFILE_THREAD(name) setProfileThreadName(name)
+
+#else
+
+#define PROFILE_ZONE(name)
+#define PROFILE_THREAD(name)
+
+#endif
+
+// call before starting any threads that record zones
+bool initProfiler();
+void closeProfiler();
+
+void setProfileThreadName(const char *name);
+
+// every zone still in the buffers that ended at or after since (a performance counter value)
+void collectProfileEvents(Uint64 since, vector<ProfileEvent> *events);
+
+// the last seconds of zones as Chrome trace_event JSON, which chrome://tracing and Perfetto can open
+bool dumpProfile(string filename, double seconds);
+
+#endif
@@ -0,0 +1,127 @@
+#include <fstream>
+#include <stdio.h>
+#include <string.h>
+
+#include "replay.hpp"
+#include "controls.hpp"
+#include "filewriter.hpp"
+
+void InputRecording::reset(string levelName) {
+    _levelName = levelName;
+    _ticks.clear();
+}
+
+void InputRecording::addTick(Uint32 buttons) {
+    _ticks.push_back(buttons);
+}
+
+bool InputRecording::save(string filename) {
+    string contents = REPLAY_FILE_VERSION_INDICATOR + '\n';
+    contents += "level " + _levelName + '\n';
+    
+    size_t runStart = 0;
+    for (size_t i = 1; i <= _ticks.size(); i++) {
+        if (i < _ticks.size() && _ticks[i] == _ticks[runStart]) {
+            continue;
+        }
+        
+        string letters;
+        for (int j = 0; j < NUMBER_OF_INPUT_BUTTONS; j++) {
+            if (_ticks[runStart] & (1 << j)) {
+                letters += INPUT_BUTTON_LETTERS[j];
+            }
+        }
+        
+        contents += to_string(i - runStart) + ' ' + (letters.empty() ? "-" : letters) + '\n';
+        runStart = i;
+    }
+    
+    return writeFileAtomically(filename, contents);
+}
+
+bool InputRecording::load(string filename) {
+    ifstream file;
+    file.open(filename);
+    
+    if (file.fail()) {
+        printf("Couldn't open replay %s\n", filename.c_str());
+        return false;
+    }
+    
+    _levelName = "";
+    _ticks.clear();
+    
+    string line;
+    int lineNumber = 0;
+    while (getline(file, line)) {
+        lineNumber++;
+        
+        // files saved on windows
+        if (!line.empty() && line.back() == '\r') {
+            line.pop_back();
+        }
+        
+        if (lineNumber == 1) {
+            if (line != REPLAY_FILE_VERSION_INDICATOR) {
+                printf("Couldn't load replay %s. Error: not a replay file\n", filename.c_str());
+                return false;
+            }
+            continue;
+        }
+        
+        if (lineNumber == 2) {
+            if (line.compare(0, 6, "level ") != 0 || line.size() == 6) {
+                printf("Couldn't load replay %s. Error: line 2: expected \"level <name>\"\n", filename.c_str());
+                return false;
+            }
+            _levelName = line.substr(6);
+            continue;
+        }
+        
+        if (line.empty()) {
+            continue;
+        }
+        
+        int count;
+        char letters[NUMBER_OF_INPUT_BUTTONS + 1];
+        char extra;
+        if (sscanf(line.c_str(), "%d %16s %c", &count, letters, &extra) != 2 || count <= 0) {
+            printf("Couldn't load replay %s. Error: line %d: expected \"<ticks> <buttons>\"\n", filename.c_str(), lineNumber);
+            return false;
+        }
+        
+        Uint32 buttons = 0;
+        if (strcmp(letters, "-") != 0) {
+            for (int i = 0; letters[i] != '\0'; i++) {
+                const char *button = strchr(INPUT_BUTTON_LETTERS, letters[i]);
+                if (!button) {
+                    printf("Couldn't load replay %s. Error: line %d: unknown button '%c'\n", filename.c_str(), lineNumber, letters[i]);
+                    return false;
+                }
+                
+                buttons |= 1 << (button - INPUT_BUTTON_LETTERS);
+            }
+        }
+        
+        _ticks.insert(_ticks.end(), count, buttons);
+    }
+    
+    if (lineNumber < 2) {
+        printf("Couldn't load replay %s. Error: no level name\n", filename.c_str());
+        return false;
+    }
+    
+    return true;
+}
+
+string InputRecording::getLevelName() {
+    return _levelName;
+}
+
+int InputRecording::getNumberOfTicks() {
+    return static_cast<int>(_ticks.size());
+}
+
+Uint32 InputRecording::getButtons(int tick) {
+    return _ticks[tick];
+}
@@ -0,0 +1,41 @@
+#ifndef replay_hpp
+#define replay_hpp
+
+#if defined __APPLE__ || defined __linux__
+#include <SDL2/SDL.h>
+#endif
+
+#ifdef _WIN64
+#include <SDL.h>
+#endif
+
+#include <string>
+#include <vector>
+using namespace std;
+
+const string REPLAY_FILE_VERSION_INDICATOR = "umihara replay 1";
+const string REPLAY_EXTENSION = ".replay";
+
+// the buttons held on every simulation tick of one run at a level, from the tick after it started.
+// physics runs at a fixed step, so playing the ticks back from the level's start does the same run again.
+//
+// files are text: the version line, "level <name>", then one "<ticks> <buttons>" line per run of ticks
+// with the same buttons held, written with INPUT_BUTTON_LETTERS or "-" for none
+class InputRecording {
+public:
+    void reset(string levelName);
+    void addTick(Uint32 buttons);
+    
+    bool save(string filename);
+    bool load(string filename);
+    
+    string getLevelName();
+    int getNumberOfTicks();
+    Uint32 getButtons(int tick);
+    
+private:
+    string _levelName;
+    vector<Uint32> _ticks;
+};
+
+#endif
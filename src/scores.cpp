@@ -0,0 +1,197 @@
+#include <filesystem>
+#include <fstream>
+#include <string.h>
+
+#include "scores.hpp"
+#include "filewriter.hpp"
+#include "mappedfile.hpp"
+
+ScoreStore::ScoreStore() {
+    _log = NULL;
+    _numberOfRecords = 0;
+}
+
+ScoreStore::~ScoreStore() {
+    close();
+}
+
+bool ScoreStore::open(string filename) {
+    close();
+    
+    _filename = filename;
+    _fastestTimes.clear();
+    _numberOfRecords = 0;
+    
+    bool needsCompacting = false;
+    
+    MappedFile file;
+    if (filesystem::exists(_filename) && file.open(_filename)) {
+        const char *data = file.getData();
+        size_t size = file.getSize();
+        
+        if (size < sizeof(SCORE_LOG_MAGIC) || memcmp(data, SCORE_LOG_MAGIC, sizeof(SCORE_LOG_MAGIC)) != 0) {
+            // the times are only a cache, so a log that's been damaged (or left empty by a crash before
+            // its first write) is kept aside for a look and a new one started in its place
+            file.close();
+            
+            string badFilename = _filename + SCORE_LOG_BAD_EXTENSION;
+            printf("Couldn't read %s. Error: not a score log, moving it to %s and starting a new one\n", _filename.c_str(), badFilename.c_str());
+            
+            error_code error;
+            filesystem::rename(_filename, badFilename, error);
+            if (error) {
+                printf("Couldn't move %s aside. Error: %s\n", _filename.c_str(), error.message().c_str());
+            }
+            
+            return compact() && openForAppending();
+        }
+        
+        // a crash mid-append can leave part of a record at the end; it never made it, so drop it
+        size_t numberOfRecords = (size - sizeof(SCORE_LOG_MAGIC)) / sizeof(ScoreRecord);
+        needsCompacting = sizeof(SCORE_LOG_MAGIC) + numberOfRecords * sizeof(ScoreRecord) != size;
+        
+        for (size_t i = 0; i < numberOfRecords; i++) {
+            ScoreRecord record;
+            memcpy(&record, data + sizeof(SCORE_LOG_MAGIC) + i * sizeof(ScoreRecord), sizeof(record));
+            
+            Uint64 timeBits = SDL_SwapLE64(record.time);
+            double time;
+            memcpy(&time, &timeBits, sizeof(time));
+            
+            Uint64 contentHash = SDL_SwapLE64(record.contentHash);
+            if (time < 0) {
+                _fastestTimes.erase(contentHash);
+            } else {
+                _fastestTimes[contentHash] = time;
+            }
+        }
+        
+        _numberOfRecords = static_cast<int>(numberOfRecords);
+        needsCompacting = needsCompacting || _numberOfRecords > static_cast<int>(_fastestTimes.size());
+        
+        file.close();
+    } else {
+        needsCompacting = true;
+    }
+    
+    if (needsCompacting && !compact()) {
+        return false;
+    }
+    
+    return openForAppending();
+}
+
+void ScoreStore::close() {
+    if (_log) {
+        fclose(_log);
+        _log = NULL;
+    }
+}
+
+double ScoreStore::getFastestTime(Uint64 contentHash) {
+    unordered_map<Uint64, double>::iterator found = _fastestTimes.find(contentHash);
+    if (found == _fastestTimes.end()) {
+        return -1;
+    }
+    
+    return found->second;
+}
+
+void ScoreStore::recordTime(Uint64 contentHash, double time) {
+    _fastestTimes[contentHash] = time;
+    append(contentHash, time);
+}
+
+void ScoreStore::clearTime(Uint64 contentHash) {
+    if (_fastestTimes.erase(contentHash) > 0) {
+        append(contentHash, -1);
+    }
+}
+
+void ScoreStore::importScoreFile(string levelFilename, Uint64 contentHash) {
+    filesystem::path filePath("levels/" + levelFilename);
+    filePath.replace_extension("hs");
+    
+    ifstream file;
+    file.open(filePath.string());
+    
+    if (file.fail()) {
+        return;
+    }
+    
+    double time = -1;
+    file >> time;
+    file.close();
+    
+    // a time already in the log is newer than anything the old file could hold
+    if (time >= 0 && getFastestTime(contentHash) < 0) {
+        recordTime(contentHash, time);
+    }
+    
+    if (_log) {
+        error_code error;
+        filesystem::remove(filePath, error);
+    }
+}
+
+void ScoreStore::append(Uint64 contentHash, double time) {
+    if (!_log) {
+        return;
+    }
+    
+    Uint64 timeBits;
+    memcpy(&timeBits, &time, sizeof(timeBits));
+    
+    ScoreRecord record;
+    record.contentHash = SDL_SwapLE64(contentHash);
+    record.time = SDL_SwapLE64(timeBits);
+    
+    if (fwrite(&record, sizeof(record), 1, _log) != 1 || fflush(_log) != 0) {
+        printf("Couldn't append to %s\n", _filename.c_str());
+        return;
+    }
+    
+    _numberOfRecords++;
+    
+    // once most of the log is superseded records, rewrite it with just the live ones
+    if (_numberOfRecords > SCORE_LOG_COMPACT_MIN && _numberOfRecords > static_cast<int>(_fastestTimes.size()) * 2) {
+        close();
+        if (compact()) {
+            openForAppending();
+        }
+    }
+}
+
+bool ScoreStore::compact() {
+    string contents(SCORE_LOG_MAGIC, sizeof(SCORE_LOG_MAGIC));
+    contents.reserve(contents.size() + _fastestTimes.size() * sizeof(ScoreRecord));
+    
+    for (unordered_map<Uint64, double>::iterator i = _fastestTimes.begin(); i != _fastestTimes.end(); i++) {
+        Uint64 timeBits;
+        memcpy(&timeBits, &i->second, sizeof(timeBits));
+        
+        ScoreRecord record;
+        record.contentHash = SDL_SwapLE64(i->first);
+        record.time = SDL_SwapLE64(timeBits);
+        
+        contents.append(reinterpret_cast<const char *>(&record), sizeof(record));
+    }
+    
+    if (!writeFileAtomically(_filename, contents)) {
+        return false;
+    }
+    
+    _numberOfRecords = static_cast<int>(_fastestTimes.size());
+    
+    return true;
+}
+
+bool ScoreStore::openForAppending() {
+    _log = fopen(_filename.c_str(), "ab");
+    if (!_log) {
+        printf("Couldn't open %s for appending\n", _filename.c_str());
+        return false;
+    }
+    
+    return true;
+}
@@ -0,0 +1,69 @@
+#ifndef scores_hpp
+#define scores_hpp
+
+#if defined __APPLE__ || defined __linux__
+#include <SDL2/SDL.h>
+#endif
+
+#ifdef _WIN64
+#include <SDL.h>
+#endif
+
+#include <stdio.h>
+#include <string>
+#include <unordered_map>
+using namespace std;
+
+const string SCORE_LOG_FILENAME = "levels/scores.log";
+const char SCORE_LOG_MAGIC[8] = { 'S', 'C', 'O', 'R', 'E', 'S', '1', '\n' };
+
+// added to the name of a log that couldn't be read, which is set aside rather than deleted
+const string SCORE_LOG_BAD_EXTENSION = ".bad";
+
+// a log smaller than this is never worth compacting while playing
+const int SCORE_LOG_COMPACT_MIN = 256;
+
+// one fixed size record per time set or cleared, both fields little endian
+struct ScoreRecord {
+    Uint64 contentHash;
+    Uint64 time;    // bits of a double, negative for a cleared time
+};
+
+// fastest times for every level, keyed by the level's content hash so an edited level starts
+// afresh and a renamed one keeps its time. times are only ever appended to one log file;
+// the newest record for a hash wins, and the older ones are dropped when the log is compacted
+class ScoreStore {
+public:
+    ScoreStore();
+    ~ScoreStore();
+    
+    // reads the whole log into memory, compacting it if it holds anything superseded. a log that
+    // isn't one is moved aside and replaced with an empty one. false if there's no log to append to,
+    // in which case times are still kept, just not saved
+    bool open(string filename);
+    void close();
+    
+    // -1 if there's no time for this content
+    double getFastestTime(Uint64 contentHash);
+    
+    void recordTime(Uint64 contentHash, double time);
+    void clearTime(Uint64 contentHash);
+    
+    // moves the time from a level's old .hs file into the log, then deletes the file
+    void importScoreFile(string levelFilename, Uint64 contentHash);
+    
+private:
+    void append(Uint64 contentHash, double time);
+    bool compact();
+    bool openForAppending();
+    
+    string _filename;
+    FILE *_log;
+    
+    unordered_map<Uint64, double> _fastestTimes;
+    
+    // records in the log, including superseded ones
+    int _numberOfRecords;
+};
+
+#endif
@@ -0,0 +1,313 @@
+#include "snapshot.hpp"
+#include "stats.hpp"
+#include "player.hpp"
+#include "grapple.hpp"
+#include "memory.hpp"
+
+GrappleSnapshot::GrappleSnapshot() {
+    _active = false;
+    
+    _hookX = 0;
+    _hookY = 0;
+    
+    _pivots = new SDL_Point[10];
+    _numberOfPivots = 0;
+    _pivotsCapacity = 10;
+}
+
+GrappleSnapshot::~GrappleSnapshot() {
+    delete[] _pivots;
+}
+
+void GrappleSnapshot::clear() {
+    _active = false;
+    _numberOfPivots = 0;
+}
+
+void GrappleSnapshot::setHook(double x, double y) {
+    _active = true;
+    
+    _hookX = x;
+    _hookY = y;
+}
+
+void GrappleSnapshot::addPivot(int drawX, int drawY) {
+    if (_numberOfPivots >= _pivotsCapacity) {
+        SDL_Point *newPivots = new SDL_Point[_pivotsCapacity * 2];
+        for (int i = 0; i < _numberOfPivots; i++) {
+            newPivots[i] = _pivots[i];
+        }
+        delete[] _pivots;
+        
+        _pivots = newPivots;
+        _pivotsCapacity *= 2;
+    }
+    
+    _pivots[_numberOfPivots].x = drawX;
+    _pivots[_numberOfPivots].y = drawY;
+    _numberOfPivots++;
+}
+
+bool GrappleSnapshot::isActive() {
+    return _active;
+}
+
+int GrappleSnapshot::getNumberOfPivots() {
+    return _active ? _numberOfPivots : 0;
+}
+
+void GrappleSnapshot::reportMemory(MemoryReport *report) {
+    report->add(SNAPSHOT_PIVOTS, _numberOfPivots * sizeof(SDL_Point), _pivotsCapacity * sizeof(SDL_Point));
+}
+
+void GrappleSnapshot::draw(SDL_Renderer *renderer, double originX, double originY, double cameraX, double cameraY) {
+    SDL_SetRenderDrawColor(renderer, 0x00, 0xFF, 0x00, 0xFF);
+    
+    if (_numberOfPivots > 0) {
+        SDL_RenderDrawLine(renderer, _hookX - cameraX, _hookY - cameraY, _pivots[0].x - cameraX, _pivots[0].y - cameraY);
+        COUNT_STAT(DRAW_CALLS, 1);
+        for (int i = 1; i < _numberOfPivots; i++) {
+            SDL_RenderDrawLine(renderer, _pivots[i - 1].x - cameraX, _pivots[i - 1].y - cameraY, _pivots[i].x - cameraX, _pivots[i].y - cameraY);
+            COUNT_STAT(DRAW_CALLS, 1);
+        }
+        SDL_RenderDrawLine(renderer, _pivots[_numberOfPivots - 1].x - cameraX, _pivots[_numberOfPivots - 1].y - cameraY, originX - cameraX, originY - cameraY);
+        COUNT_STAT(DRAW_CALLS, 1);
+    } else {
+        SDL_RenderDrawLine(renderer, static_cast<int>(originX - cameraX), static_cast<int>(originY - cameraY), _hookX - cameraX, _hookY - cameraY);
+        COUNT_STAT(DRAW_CALLS, 1);
+    }
+    
+    // square where the hook is
+    SDL_SetRenderDrawColor(renderer, 0x00, 0x00, 0xFF, 0xFF);
+    SDL_Rect grappleRect = { static_cast<int>(_hookX - cameraX) - GRAPPLE_RECT_HALF_WIDTH, static_cast<int>(_hookY - cameraY) - GRAPPLE_RECT_HALF_WIDTH, GRAPPLE_RECT_HALF_WIDTH * 2, GRAPPLE_RECT_HALF_WIDTH * 2 };
+    SDL_RenderFillRect(renderer, &grappleRect);
+    COUNT_STAT(DRAW_CALLS, 1);
+}
+
+RenderSnapshot::RenderSnapshot() {
+    _gameState = 0;
+    
+    _cameraX = 0;
+    _cameraY = 0;
+    
+    _player.x = 0;
+    _player.y = 0;
+    _player.width = PLATFORM_WIDTH;
+    _player.height = PLATFORM_HEIGHT;
+    _player.velocityX = 0;
+    _player.velocityY = 0;
+    _player.aim = -1;
+    _player.facing = RIGHT;
+    
+    _editorCursorX = 0;
+    _editorCursorY = 0;
+    _editorMode = 0;
+    
+    clearStats(&_simulationStats);
+    _updateTime = 0;
+}
+
+int RenderSnapshot::getGameState() {
+    return _gameState;
+}
+
+void RenderSnapshot::setGameState(int gameState) {
+    _gameState = gameState;
+}
+
+string RenderSnapshot::getLevelName() {
+    return _levelName;
+}
+
+void RenderSnapshot::setLevelName(const string &levelName) {
+    // assigned rather than swapped, so a name no longer than the last reuses its buffer
+    _levelName = levelName;
+}
+
+double RenderSnapshot::getCameraX() {
+    return _cameraX;
+}
+
+double RenderSnapshot::getCameraY() {
+    return _cameraY;
+}
+
+void RenderSnapshot::setCamera(double x, double y) {
+    _cameraX = x;
+    _cameraY = y;
+}
+
+PlayerSnapshot *RenderSnapshot::getPlayer() {
+    return &_player;
+}
+
+GrappleSnapshot *RenderSnapshot::getGrapple() {
+    return &_grapple;
+}
+
+Level *RenderSnapshot::getLevel() {
+    return &_level;
+}
+
+void RenderSnapshot::copyLevel(Level *level) {
+    if (_level.getRevision() != level->getRevision()) {
+        _level.copyGeometry(level);
+    }
+}
+
+int RenderSnapshot::getEditorCursorX() {
+    return _editorCursorX;
+}
+
+int RenderSnapshot::getEditorCursorY() {
+    return _editorCursorY;
+}
+
+int RenderSnapshot::getEditorMode() {
+    return _editorMode;
+}
+
+void RenderSnapshot::setEditorCursor(int x, int y, int mode) {
+    _editorCursorX = x;
+    _editorCursorY = y;
+    _editorMode = mode;
+}
+
+StatCounts *RenderSnapshot::getSimulationStats() {
+    return &_simulationStats;
+}
+
+double RenderSnapshot::getUpdateTime() {
+    return _updateTime;
+}
+
+void RenderSnapshot::setSimulationStats(StatCounts *stats, double updateTime) {
+    _simulationStats = *stats;
+    _updateTime = updateTime;
+}
+
+void RenderSnapshot::reportMemory(MemoryReport *report) {
+    _level.reportMemory(report);
+    _grapple.reportMemory(report);
+}
+
+void RenderSnapshot::drawPlayer(SDL_Renderer *renderer, double cameraX, double cameraY) {
+    double x = _player.x;
+    double y = _player.y;
+    
+    if (_grapple.isActive()) {
+        _grapple.draw(renderer, x + _player.width / 2, y + _player.height / 2, cameraX, cameraY);
+    }
+    
+    SDL_SetRenderDrawColor(renderer, 0xFF, 0x00, 0x00, 0xFF);
+    
+    SDL_Rect rect = { static_cast<int>(x - cameraX), static_cast<int>(y - cameraY), _player.width, _player.height };
+    SDL_RenderFillRect(renderer, &rect);
+    COUNT_STAT(DRAW_CALLS, 1);
+    
+    // eyes whites
+    SDL_SetRenderDrawColor(renderer, 0xFF, 0xFF, 0xFF, 0xFF);
+    
+    SDL_Rect leftWhiteRect = { static_cast<int>(x - cameraX) + LEFT_EYE_POS, static_cast<int>(y - cameraY) + EYE_HEIGHT, EYE_WIDTH, EYE_WIDTH };
+    SDL_RenderFillRect(renderer, &leftWhiteRect);
+    COUNT_STAT(DRAW_CALLS, 1);
+    
+    SDL_Rect rightWhiteRect = { static_cast<int>(x - cameraX) + RIGHT_EYE_POS, static_cast<int>(y - cameraY) + EYE_HEIGHT, EYE_WIDTH, EYE_WIDTH };
+    SDL_RenderFillRect(renderer, &rightWhiteRect);
+    COUNT_STAT(DRAW_CALLS, 1);
+    
+    // pupils
+    SDL_SetRenderDrawColor(renderer, 0x00, 0x00, 0x00, 0xFF);
+    
+    int lookXOffset = 0;
+    int lookYOffset = 0;
+    
+    switch (_player.aim) {
+        case UPLEFT:
+            lookXOffset -= LOOK_DISTANCE;
+            lookYOffset -= LOOK_DISTANCE;
+            break;
+        case UP:
+            lookYOffset -= LOOK_DISTANCE;
+            break;
+        case UPRIGHT:
+            lookXOffset += LOOK_DISTANCE;
+            lookYOffset -= LOOK_DISTANCE;
+            break;
+        case DOWNLEFT:
+            lookXOffset -= LOOK_DISTANCE;
+            lookYOffset += LOOK_DISTANCE;
+            break;
+        case DOWN:
+            lookYOffset += LOOK_DISTANCE;
+            break;
+        case DOWNRIGHT:
+            lookXOffset += LOOK_DISTANCE;
+            lookYOffset += LOOK_DISTANCE;
+            break;
+        default:
+            if (_player.facing == LEFT) {
+                lookXOffset -= LOOK_DISTANCE;
+            } else if (_player.facing == RIGHT) {
+                lookXOffset += LOOK_DISTANCE;
+            }
+            break;
+    }
+    
+    SDL_Rect leftPupilRect = { leftWhiteRect.x + EYE_WIDTH / 2 - PUPIL_WIDTH / 2 + lookXOffset, leftWhiteRect.y + EYE_WIDTH / 2 - PUPIL_WIDTH / 2 + lookYOffset, PUPIL_WIDTH, PUPIL_WIDTH };
+    SDL_Rect rightPupilRect = { rightWhiteRect.x + EYE_WIDTH / 2 - PUPIL_WIDTH / 2 + lookXOffset, rightWhiteRect.y + EYE_WIDTH / 2 - PUPIL_WIDTH / 2 + lookYOffset, PUPIL_WIDTH, PUPIL_WIDTH };
+    
+    SDL_RenderFillRect(renderer, &leftPupilRect);
+    COUNT_STAT(DRAW_CALLS, 1);
+    SDL_RenderFillRect(renderer, &rightPupilRect);
+    COUNT_STAT(DRAW_CALLS, 1);
+}
+
+SnapshotBuffer::SnapshotBuffer() {
+    SDL_AtomicSet(&_front, -1);
+    SDL_AtomicSet(&_reading, -1);
+    _back = 0;
+}
+
+RenderSnapshot *SnapshotBuffer::beginWrite() {
+    int front = SDL_AtomicGet(&_front);
+    _back = (front < 0) ? 0 : 1 - front;
+    
+    if (SDL_AtomicGet(&_reading) == _back) {
+        return NULL;
+    }
+    
+    return _snapshots + _back;
+}
+
+void SnapshotBuffer::publish() {
+    SDL_AtomicSet(&_front, _back);
+}
+
+RenderSnapshot *SnapshotBuffer::acquire() {
+    while (true) {
+        int front = SDL_AtomicGet(&_front);
+        if (front < 0) {
+            return NULL;
+        }
+        
+        SDL_AtomicSet(&_reading, front);
+        
+        // the simulation may have published (and started rewriting this buffer) in between
+        if (SDL_AtomicGet(&_front) == front) {
+            return _snapshots + front;
+        }
+    }
+}
+
+void SnapshotBuffer::release() {
+    SDL_AtomicSet(&_reading, -1);
+}
+
+void SnapshotBuffer::reportMemory(MemoryReport *report) {
+    for (int i = 0; i < 2; i++) {
+        string levelName = _snapshots[i].getLevelName();
+        report->beginSection("level " + (levelName.empty() ? string("(none)") : levelName) + ", snapshot " + to_string(i + 1));
+        _snapshots[i].reportMemory(report);
+    }
+}
@@ -0,0 +1,139 @@
+#ifndef snapshot_hpp
+#define snapshot_hpp
+
+#if defined __APPLE__ || defined __linux__
+#include <SDL2/SDL.h>
+#endif
+
+#ifdef _WIN64
+#include <SDL.h>
+#endif
+
+#include "level.hpp"
+#include "stats.hpp"
+
+// everything the renderer needs to draw the player for one frame
+struct PlayerSnapshot {
+    double x;
+    double y;
+    int width;
+    int height;
+    
+    double velocityX;
+    double velocityY;
+    
+    int aim;
+    int facing;
+};
+
+// a rope or a grapple seeker, flattened to the points the line passes through
+class GrappleSnapshot {
+public:
+    GrappleSnapshot();
+    ~GrappleSnapshot();
+    
+    void clear();
+    void setHook(double x, double y);
+    void addPivot(int drawX, int drawY);
+    
+    bool isActive();
+    int getNumberOfPivots();
+    
+    void draw(SDL_Renderer *renderer, double originX, double originY, double cameraX, double cameraY);
+    
+    void reportMemory(MemoryReport *report);
+
+private:
+    bool _active;
+    
+    double _hookX;
+    double _hookY;
+    
+    SDL_Point *_pivots;
+    int _numberOfPivots;
+    int _pivotsCapacity;
+};
+
+// immutable copy of the simulation state, produced once per tick and drawn by the render thread
+class RenderSnapshot {
+public:
+    RenderSnapshot();
+    
+    int getGameState();
+    void setGameState(int gameState);
+    
+    string getLevelName();
+    void setLevelName(const string &levelName);
+    
+    double getCameraX();
+    double getCameraY();
+    void setCamera(double x, double y);
+    
+    PlayerSnapshot *getPlayer();
+    GrappleSnapshot *getGrapple();
+    
+    Level *getLevel();
+    void copyLevel(Level *level);
+    
+    int getEditorCursorX();
+    int getEditorCursorY();
+    int getEditorMode();
+    void setEditorCursor(int x, int y, int mode);
+    
+    // the simulation's counts and gameUpdate time (in milliseconds) since the last snapshot it published
+    StatCounts *getSimulationStats();
+    double getUpdateTime();
+    void setSimulationStats(StatCounts *stats, double updateTime);
+    
+    void drawPlayer(SDL_Renderer *renderer, double cameraX, double cameraY);
+    
+    // the copy of the level and the rope, into the report's current section
+    void reportMemory(MemoryReport *report);
+
+private:
+    int _gameState;
+    string _levelName;
+    
+    double _cameraX;
+    double _cameraY;
+    
+    PlayerSnapshot _player;
+    GrappleSnapshot _grapple;
+    
+    // only recopied when the source level's revision changes
+    Level _level;
+    
+    int _editorCursorX;
+    int _editorCursorY;
+    int _editorMode;
+    
+    StatCounts _simulationStats;
+    double _updateTime;
+};
+
+// two snapshots handed between the simulation and render threads without locking.
+// the simulation writes the back buffer and publishes it, the renderer reads the front one.
+class SnapshotBuffer {
+public:
+    SnapshotBuffer();
+    
+    // returns NULL when the renderer is still holding the back buffer; skip the snapshot this tick
+    RenderSnapshot *beginWrite();
+    void publish();
+    
+    // returns NULL until the first snapshot has been published
+    RenderSnapshot *acquire();
+    void release();
+    
+    // a section for each snapshot
+    void reportMemory(MemoryReport *report);
+
+private:
+    RenderSnapshot _snapshots[2];
+    
+    SDL_atomic_t _front;    // last published buffer, -1 if none
+    SDL_atomic_t _reading;  // buffer held by the renderer, -1 if none
+    int _back;
+};
+
+#endif
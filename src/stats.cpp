@@ -0,0 +1,23 @@
+#include "stats.hpp"
+
+// zero initialised, so there's nothing to construct the first time a thread counts something
+thread_local ThreadStats threadStats = {};
+
+void takeStats(StatCounts *counts) {
+    for (int i = 0; i < NUMBER_OF_STAT_COUNTERS; i++) {
+        counts->counts[i] = threadStats.counts[i].load(memory_order_relaxed);
+        threadStats.counts[i].store(0, memory_order_relaxed);
+    }
+}
+
+void clearStats(StatCounts *counts) {
+    for (int i = 0; i < NUMBER_OF_STAT_COUNTERS; i++) {
+        counts->counts[i] = 0;
+    }
+}
+
+void addStats(StatTotals *totals, StatCounts *counts) {
+    for (int i = 0; i < NUMBER_OF_STAT_COUNTERS; i++) {
+        totals->counts[i] += counts->counts[i];
+    }
+}
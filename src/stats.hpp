@@ -0,0 +1,82 @@
+#ifndef stats_hpp
+#define stats_hpp
+
+#include <atomic>
+#include <string>
+using namespace std;
+
+// counts the engine keeps as it goes, for the performance overlay and --frame-stats. each thread has
+// its own set; the simulation takes its counts once a tick and hands them to the renderer in the
+// snapshot, and the renderer takes its own once a frame.
+//
+// building with UMIHARA_NO_COUNTERS (cmake -DUMIHARA_COUNTERS=OFF) compiles every COUNT_STAT out
+
+enum StatCounter {
+    DRAW_CALLS,
+    
+    // whole-level loops over the platforms: player collisions, seeker steps and rope corner checks
+    PLATFORM_SCANS,
+    PLATFORMS_TESTED,
+    
+    LINE_RECT_TESTS,            // getLineRectangleCollision and checkLineRectCollision
+    PLAYER_COLLISION_CHECKS,    // Player::checkCollision from Player::update
+    PIVOTS_ADDED,               // to the rope
+    PIVOTS_REMOVED,
+    SEEKER_STEPS,
+    
+    // operator new calls and the bytes they asked for. only counted with UMIHARA_TRACK_ALLOCATIONS (see allocations.hpp)
+    ALLOCATIONS,
+    ALLOCATED_BYTES,
+    
+    NUMBER_OF_STAT_COUNTERS
+};
+
+const string STAT_COUNTER_STRINGS[NUMBER_OF_STAT_COUNTERS] = {
+    "draw calls",
+    "platform scans",
+    "platforms tested",
+    "line-rect tests",
+    "player collision checks",
+    "pivots added",
+    "pivots removed",
+    "seeker steps",
+    "allocations",
+    "allocated bytes"
+};
+
+// one thread's running counts. only that thread adds to them, so adding is a relaxed load and store
+// rather than a locked increment, and any other thread can still read them without tearing
+struct ThreadStats {
+    atomic<int> counts[NUMBER_OF_STAT_COUNTERS];
+};
+
+// counts taken at one point, to pass around and add up
+struct StatCounts {
+    int counts[NUMBER_OF_STAT_COUNTERS];
+};
+
+// counts added up over a whole session, which a tick's worth of ints would overflow
+struct StatTotals {
+    long long counts[NUMBER_OF_STAT_COUNTERS];
+};
+
+extern thread_local ThreadStats threadStats;
+
+inline void countStat(int counter, int amount) {
+    atomic<int> *count = threadStats.counts + counter;
+    count->store(count->load(memory_order_relaxed) + amount, memory_order_relaxed);
+}
+
+#ifdef UMIHARA_NO_COUNTERS
+#define COUNT_STAT(counter, amount)
+#else
+#define COUNT_STAT(counter, amount) countStat(counter, amount)
+#endif
+
+// copies this thread's counts into counts and starts them again from zero
+void takeStats(StatCounts *counts);
+
+void clearStats(StatCounts *counts);
+void addStats(StatTotals *totals, StatCounts *counts);
+
+#endif
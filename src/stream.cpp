@@ -0,0 +1,411 @@
+#include <algorithm>
+
+#include "stream.hpp"
+#include "memory.hpp"
+
+LevelStream::LevelStream() {
+    _dataOffset = 0;
+    _width = 0;
+    _height = 0;
+    _chunksAcross = 0;
+    _chunksDown = 0;
+    
+    _platformTable = new Platform *[10];
+    _numberOfPlatforms = 0;
+    _platformTableCapacity = 10;
+    
+    _thread = NULL;
+    _mutex = NULL;
+    _requestsChanged = NULL;
+    _chunkLoaded = NULL;
+    _stopping = false;
+}
+
+LevelStream::~LevelStream() {
+    close();
+    
+    delete[] _platformTable;
+}
+
+bool LevelStream::open(string filename, size_t dataOffset, int width, int height) {
+    close();
+    
+    _filename = filename;
+    _dataOffset = dataOffset;
+    _width = width;
+    _height = height;
+    _chunksAcross = (width + CHUNK_SIZE - 1) / CHUNK_SIZE;
+    _chunksDown = (height + CHUNK_SIZE - 1) / CHUNK_SIZE;
+    
+    _mutex = SDL_CreateMutex();
+    _requestsChanged = SDL_CreateCond();
+    _chunkLoaded = SDL_CreateCond();
+    if (!_mutex || !_requestsChanged || !_chunkLoaded) {
+        printf("Couldn't create level streaming locks. Error: %s\n", SDL_GetError());
+        close();
+        return false;
+    }
+    
+    _stopping = false;
+    _thread = SDL_CreateThread(loadChunks, "level streaming", this);
+    if (!_thread) {
+        printf("Couldn't create level streaming thread. Error: %s\n", SDL_GetError());
+        close();
+        return false;
+    }
+    
+    return true;
+}
+
+void LevelStream::close() {
+    if (_thread) {
+        SDL_LockMutex(_mutex);
+        _stopping = true;
+        SDL_CondSignal(_requestsChanged);
+        SDL_UnlockMutex(_mutex);
+        
+        SDL_WaitThread(_thread, NULL);
+        _thread = NULL;
+    }
+    
+    for (int i = 0; i < static_cast<int>(_loaded.size()); i++) {
+        delete[] _loaded[i]->platforms;
+        delete _loaded[i];
+    }
+    _loaded.clear();
+    _requests.clear();
+    
+    for (map<Uint64, LevelChunk *>::iterator i = _resident.begin(); i != _resident.end(); i++) {
+        delete[] i->second->platforms;
+        delete i->second;
+    }
+    _resident.clear();
+    _pending.clear();
+    
+    _numberOfPlatforms = 0;
+    
+    SDL_DestroyCond(_chunkLoaded);
+    SDL_DestroyCond(_requestsChanged);
+    SDL_DestroyMutex(_mutex);
+    _chunkLoaded = NULL;
+    _requestsChanged = NULL;
+    _mutex = NULL;
+}
+
+bool LevelStream::update(int x, int y, int w, int h) {
+    bool changed = takeLoadedChunks(false);
+    
+    SDL_Rect loadRange;
+    SDL_Rect keepRange;
+    bool wanted = getChunkRange(x - CHUNK_PREFETCH_DISTANCE, y - CHUNK_PREFETCH_DISTANCE, w + CHUNK_PREFETCH_DISTANCE * 2, h + CHUNK_PREFETCH_DISTANCE * 2, 0, &loadRange);
+    getChunkRange(x - CHUNK_PREFETCH_DISTANCE, y - CHUNK_PREFETCH_DISTANCE, w + CHUNK_PREFETCH_DISTANCE * 2, h + CHUNK_PREFETCH_DISTANCE * 2, 1, &keepRange);
+    
+    // drop what's now too far away, both resident and still queued
+    map<Uint64, LevelChunk *>::iterator i = _resident.begin();
+    while (i != _resident.end()) {
+        SDL_Point chunk = { i->second->x, i->second->y };
+        if (!wanted || !SDL_PointInRect(&chunk, &keepRange)) {
+            delete[] i->second->platforms;
+            delete i->second;
+            i = _resident.erase(i);
+            
+            changed = true;
+        } else {
+            i++;
+        }
+    }
+    
+    SDL_LockMutex(_mutex);
+    deque<Uint64> requests;
+    for (int j = 0; j < static_cast<int>(_requests.size()); j++) {
+        SDL_Point chunk = { static_cast<int>(_requests[j] & 0xFFFFFFFF), static_cast<int>(_requests[j] >> 32) };
+        if (wanted && SDL_PointInRect(&chunk, &keepRange)) {
+            requests.push_back(_requests[j]);
+        } else {
+            _pending.erase(_requests[j]);
+        }
+    }
+    _requests.swap(requests);
+    SDL_UnlockMutex(_mutex);
+    
+    if (wanted) {
+        // nearest chunks first
+        int centerX = (x + w / 2) / (CHUNK_SIZE * PLATFORM_WIDTH);
+        int centerY = (y + h / 2) / (CHUNK_SIZE * PLATFORM_HEIGHT);
+        
+        vector<pair<int, Uint64>> missing;
+        for (int chunkY = loadRange.y; chunkY < loadRange.y + loadRange.h; chunkY++) {
+            for (int chunkX = loadRange.x; chunkX < loadRange.x + loadRange.w; chunkX++) {
+                Uint64 key = chunkKey(chunkX, chunkY);
+                if (_resident.count(key) == 0 && _pending.count(key) == 0) {
+                    missing.push_back(make_pair(abs(chunkX - centerX) + abs(chunkY - centerY), key));
+                }
+            }
+        }
+        sort(missing.begin(), missing.end());
+        
+        for (int j = 0; j < static_cast<int>(missing.size()); j++) {
+            request(missing[j].second, false);
+        }
+    }
+    
+    if (changed) {
+        rebuildPlatformTable();
+    }
+    
+    return changed;
+}
+
+bool LevelStream::require(int x, int y, int w, int h) {
+    bool changed = takeLoadedChunks(true);
+    
+    SDL_Rect range;
+    if (!getChunkRange(x, y, w, h, 0, &range)) {
+        return changed;
+    }
+    
+    for (int chunkY = range.y; chunkY < range.y + range.h; chunkY++) {
+        for (int chunkX = range.x; chunkX < range.x + range.w; chunkX++) {
+            if (_resident.count(chunkKey(chunkX, chunkY)) == 0) {
+                request(chunkKey(chunkX, chunkY), true);
+            }
+        }
+    }
+    
+    for (int chunkY = range.y; chunkY < range.y + range.h; chunkY++) {
+        for (int chunkX = range.x; chunkX < range.x + range.w; chunkX++) {
+            // a miss; wait for the loader
+            while (_resident.count(chunkKey(chunkX, chunkY)) == 0) {
+                SDL_LockMutex(_mutex);
+                while (_loaded.empty()) {
+                    SDL_CondWait(_chunkLoaded, _mutex);
+                }
+                SDL_UnlockMutex(_mutex);
+                
+                changed = takeLoadedChunks(true) || changed;
+            }
+        }
+    }
+    
+    return changed;
+}
+
+int LevelStream::getNumberOfPlatforms() {
+    return _numberOfPlatforms;
+}
+
+Platform *LevelStream::getPlatform(int i) {
+    if (i >= 0 && i < _numberOfPlatforms) {
+        return _platformTable[i];
+    }
+    
+    return NULL;
+}
+
+void LevelStream::reportMemory(MemoryReport *report) {
+    // chunks are allocated at exactly their size; only the table over them grows
+    for (map<Uint64, LevelChunk *>::iterator i = _resident.begin(); i != _resident.end(); i++) {
+        size_t size = sizeof(LevelChunk) + i->second->numberOfPlatforms * sizeof(Platform);
+        report->add(STREAMED_CHUNKS, size, size);
+    }
+    
+    report->add(STREAMED_CHUNKS, _numberOfPlatforms * sizeof(Platform *), _platformTableCapacity * sizeof(Platform *));
+}
+
+int LevelStream::loadChunks(void *data) {
+    LevelStream *stream = static_cast<LevelStream *>(data);
+    
+    ifstream file;
+    file.open(stream->_filename, ios_base::binary);
+    if (file.fail()) {
+        printf("Couldn't open %s for streaming\n", stream->_filename.c_str());
+    }
+    
+    SDL_LockMutex(stream->_mutex);
+    while (true) {
+        while (stream->_requests.empty() && !stream->_stopping) {
+            SDL_CondWait(stream->_requestsChanged, stream->_mutex);
+        }
+        
+        if (stream->_stopping) {
+            break;
+        }
+        
+        Uint64 key = stream->_requests.front();
+        stream->_requests.pop_front();
+        
+        // the file is only touched here, so read without holding the lock
+        SDL_UnlockMutex(stream->_mutex);
+        LevelChunk *chunk = stream->readChunk(file, key);
+        SDL_LockMutex(stream->_mutex);
+        
+        stream->_loaded.push_back(chunk);
+        SDL_CondSignal(stream->_chunkLoaded);
+    }
+    SDL_UnlockMutex(stream->_mutex);
+    
+    file.close();
+    
+    return 0;
+}
+
+LevelChunk *LevelStream::readChunk(ifstream &file, Uint64 key) {
+    LevelChunk *chunk = new LevelChunk;
+    chunk->x = static_cast<int>(key & 0xFFFFFFFF);
+    chunk->y = static_cast<int>(key >> 32);
+    chunk->platforms = NULL;
+    chunk->numberOfPlatforms = 0;
+    
+    Uint8 tiles[CHUNK_BYTES];
+    
+    file.seekg(_dataOffset + (static_cast<size_t>(chunk->y) * _chunksAcross + chunk->x) * CHUNK_BYTES);
+    file.read(reinterpret_cast<char *>(tiles), CHUNK_BYTES);
+    
+    // hand back an empty chunk rather than leave require() waiting forever
+    if (file.fail()) {
+        printf("Couldn't read chunk %d, %d of %s\n", chunk->x, chunk->y, _filename.c_str());
+        file.clear();
+        return chunk;
+    }
+    
+    int numberOfPlatforms = 0;
+    for (int tile = 0; tile < CHUNK_SIZE * CHUNK_SIZE; tile++) {
+        int type = (tiles[tile / 2] >> ((tile % 2) * 4)) & 0x0F;
+        if (type != 0 && type <= NUMBER_OF_PLATFORM_TYPES) {
+            numberOfPlatforms++;
+        }
+    }
+    
+    chunk->platforms = new Platform[numberOfPlatforms];
+    for (int tile = 0; tile < CHUNK_SIZE * CHUNK_SIZE; tile++) {
+        int type = (tiles[tile / 2] >> ((tile % 2) * 4)) & 0x0F;
+        if (type == 0 || type > NUMBER_OF_PLATFORM_TYPES) {
+            continue;
+        }
+        
+        int x = chunk->x * CHUNK_SIZE + tile % CHUNK_SIZE;
+        int y = chunk->y * CHUNK_SIZE + tile / CHUNK_SIZE;
+        
+        chunk->platforms[chunk->numberOfPlatforms] = Platform(x * PLATFORM_WIDTH, y * PLATFORM_HEIGHT, PLATFORM_WIDTH, PLATFORM_HEIGHT, type - 1);
+        chunk->numberOfPlatforms++;
+    }
+    
+    return chunk;
+}
+
+Uint64 LevelStream::chunkKey(int x, int y) {
+    return static_cast<Uint64>(y) << 32 | static_cast<Uint32>(x);
+}
+
+bool LevelStream::getChunkRange(int x, int y, int w, int h, int margin, SDL_Rect *range) {
+    int chunkWidth = CHUNK_SIZE * PLATFORM_WIDTH;
+    int chunkHeight = CHUNK_SIZE * PLATFORM_HEIGHT;
+    
+    // round towards negative infinity so areas hanging off the top left still work
+    int left = (x >= 0 ? x / chunkWidth : (x - chunkWidth + 1) / chunkWidth) - margin;
+    int top = (y >= 0 ? y / chunkHeight : (y - chunkHeight + 1) / chunkHeight) - margin;
+    int right = (x + w - 1) / chunkWidth + margin;
+    int bottom = (y + h - 1) / chunkHeight + margin;
+    
+    left = max(left, 0);
+    top = max(top, 0);
+    right = min(right, _chunksAcross - 1);
+    bottom = min(bottom, _chunksDown - 1);
+    
+    if (right < left || bottom < top) {
+        return false;
+    }
+    
+    range->x = left;
+    range->y = top;
+    range->w = right - left + 1;
+    range->h = bottom - top + 1;
+    
+    return true;
+}
+
+void LevelStream::request(Uint64 key, bool urgent) {
+    SDL_LockMutex(_mutex);
+    
+    if (_pending.count(key) > 0) {
+        if (urgent) {
+            // already queued behind prefetches; move it to the front
+            deque<Uint64>::iterator queued = find(_requests.begin(), _requests.end(), key);
+            if (queued != _requests.end()) {
+                _requests.erase(queued);
+                _requests.push_front(key);
+            }
+        }
+    } else {
+        _pending.insert(key);
+        
+        if (urgent) {
+            _requests.push_front(key);
+        } else {
+            _requests.push_back(key);
+        }
+        SDL_CondSignal(_requestsChanged);
+    }
+    
+    SDL_UnlockMutex(_mutex);
+}
+
+bool LevelStream::takeLoadedChunks(bool append) {
+    vector<LevelChunk *> loaded;
+    
+    SDL_LockMutex(_mutex);
+    loaded.swap(_loaded);
+    for (int i = 0; i < static_cast<int>(loaded.size()); i++) {
+        _pending.erase(chunkKey(loaded[i]->x, loaded[i]->y));
+    }
+    SDL_UnlockMutex(_mutex);
+    
+    bool changed = false;
+    for (int i = 0; i < static_cast<int>(loaded.size()); i++) {
+        Uint64 key = chunkKey(loaded[i]->x, loaded[i]->y);
+        
+        if (_resident.count(key) > 0) {
+            delete[] loaded[i]->platforms;
+            delete loaded[i];
+            continue;
+        }
+        
+        _resident[key] = loaded[i];
+        changed = true;
+        
+        if (append) {
+            appendPlatforms(loaded[i]);
+        }
+    }
+    
+    return changed;
+}
+
+void LevelStream::appendPlatforms(LevelChunk *chunk) {
+    if (_numberOfPlatforms + chunk->numberOfPlatforms >= _platformTableCapacity) {
+        while (_numberOfPlatforms + chunk->numberOfPlatforms >= _platformTableCapacity) {
+            _platformTableCapacity *= 2;
+        }
+        
+        Platform **newTable = new Platform *[_platformTableCapacity];
+        for (int i = 0; i < _numberOfPlatforms; i++) {
+            newTable[i] = _platformTable[i];
+        }
+        delete[] _platformTable;
+        
+        _platformTable = newTable;
+    }
+    
+    for (int i = 0; i < chunk->numberOfPlatforms; i++) {
+        _platformTable[_numberOfPlatforms] = chunk->platforms + i;
+        _numberOfPlatforms++;
+    }
+}
+
+void LevelStream::rebuildPlatformTable() {
+    _numberOfPlatforms = 0;
+    
+    for (map<Uint64, LevelChunk *>::iterator i = _resident.begin(); i != _resident.end(); i++) {
+        appendPlatforms(i->second);
+    }
+}
@@ -0,0 +1,99 @@
+#ifndef stream_hpp
+#define stream_hpp
+
+#if defined __APPLE__ || defined __linux__
+#include <SDL2/SDL.h>
+#endif
+
+#ifdef _WIN64
+#include <SDL.h>
+#endif
+
+#include <fstream>
+#include <deque>
+#include <map>
+#include <set>
+#include <vector>
+#include <string>
+
+#include "level.hpp"
+using namespace std;
+
+// chunks are CHUNK_SIZE x CHUNK_SIZE tiles, packed like "B" tiles and stored one after another
+const int CHUNK_SIZE = 64;
+const int CHUNK_BYTES = CHUNK_SIZE * CHUNK_SIZE / 2;
+
+// chunks are requested this many pixels ahead of the area being streamed around, and only
+// dropped once they're a whole chunk further out than that
+const int CHUNK_PREFETCH_DISTANCE = CHUNK_SIZE * PLATFORM_WIDTH / 2;
+
+struct LevelChunk {
+    int x;
+    int y;
+    
+    Platform *platforms;
+    int numberOfPlatforms;
+};
+
+// pages the chunks of a "C" level in and out around an area on a background thread.
+// everything but the loader itself runs on the simulation thread
+class LevelStream {
+public:
+    LevelStream();
+    ~LevelStream();
+    
+    bool open(string filename, size_t dataOffset, int width, int height);
+    void close();
+    
+    // takes in finished chunks, requests the ones around the area and drops the ones well outside it.
+    // returns true if the resident platforms changed
+    bool update(int x, int y, int w, int h);
+    
+    // blocks until every chunk overlapping the area is resident. only ever adds platforms, so
+    // indexes from before the call stay valid. returns true if the resident platforms changed
+    bool require(int x, int y, int w, int h);
+    
+    // every platform in a resident chunk
+    int getNumberOfPlatforms();
+    Platform *getPlatform(int i);
+    
+    void reportMemory(MemoryReport *report);
+    
+private:
+    static int loadChunks(void *data);
+    LevelChunk *readChunk(ifstream &file, Uint64 key);
+    
+    Uint64 chunkKey(int x, int y);
+    bool getChunkRange(int x, int y, int w, int h, int margin, SDL_Rect *range);
+    
+    void request(Uint64 key, bool urgent);
+    bool takeLoadedChunks(bool append);
+    void appendPlatforms(LevelChunk *chunk);
+    void rebuildPlatformTable();
+    
+    string _filename;
+    size_t _dataOffset;
+    int _width;
+    int _height;
+    int _chunksAcross;
+    int _chunksDown;
+    
+    // keyed by y << 32 | x so the platform table comes out in the same order every time
+    map<Uint64, LevelChunk *> _resident;
+    set<Uint64> _pending;
+    
+    Platform **_platformTable;
+    int _numberOfPlatforms;
+    int _platformTableCapacity;
+    
+    // shared with the loader thread
+    SDL_Thread *_thread;
+    SDL_mutex *_mutex;
+    SDL_cond *_requestsChanged;
+    SDL_cond *_chunkLoaded;
+    deque<Uint64> _requests;
+    vector<LevelChunk *> _loaded;
+    bool _stopping;
+};
+
+#endif
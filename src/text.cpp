@@ -1,12 +1,76 @@
+#include <algorithm>
+#include <map>
+
 #include "text.hpp"
+#include "font.hpp"
+#include "profiler.hpp"
+#include "stats.hpp"
+#include "memory.hpp"
 using namespace std;
 
+map<int, TTF_Font *> fonts;
+
+// added up as text boxes render and destroy their textures. the fonts and these are used from both
+// threads, always under the game's UI lock (see gameLockUi)
+int numberOfTextTextures = 0;
+size_t textTextureBytes = 0;
+
+// textures a text box has let go of. the simulation thread resizes and deletes text boxes too, but SDL
+// textures can only be destroyed on the render thread, so they wait here until it calls
+// destroyRetiredTextTextures. plain globals, so text boxes destroyed at exit can still add to them
+SDL_Texture **retiredTextTextures = NULL;
+int numberOfRetiredTextTextures = 0;
+int retiredTextTexturesCapacity = 0;
+
+TTF_Font *getFont(int fontSize) {
+    map<int, TTF_Font *>::iterator font = fonts.find(fontSize);
+    if (font != fonts.end()) {
+        return font->second;
+    }
+    
+    TTF_Font *newFont = TTF_OpenFontRW(SDL_RWFromConstMem(FONT_DATA, static_cast<int>(FONT_DATA_SIZE)), 1, fontSize);
+    if (!newFont) {
+        printf("Couldn't open font. Error: %s\n", TTF_GetError());
+        return NULL;
+    }
+    
+    fonts[fontSize] = newFont;
+    return newFont;
+}
+
+void destroyRetiredTextTextures() {
+    for (int i = 0; i < numberOfRetiredTextTextures; i++) {
+        SDL_DestroyTexture(retiredTextTextures[i]);
+    }
+    numberOfRetiredTextTextures = 0;
+}
+
+void closeFonts() {
+    for (map<int, TTF_Font *>::iterator i = fonts.begin(); i != fonts.end(); i++) {
+        TTF_CloseFont(i->second);
+    }
+    fonts.clear();
+}
+
+void reportTextMemory(MemoryReport *report) {
+    if (numberOfTextTextures > 0) {
+        report->add(TEXT_TEXTURES, textTextureBytes, textTextureBytes, numberOfTextTextures);
+    }
+    
+    // the fonts all read the embedded data in place, so it's counted once. SDL_ttf's own glyph caches can't be seen from here
+    for (map<int, TTF_Font *>::iterator i = fonts.begin(); i != fonts.end(); i++) {
+        size_t size = i == fonts.begin() ? FONT_DATA_SIZE : 0;
+        report->add(FONTS, size, size);
+    }
+}
+
 TextBox::TextBox() {
     _x = 0;
     _y = 0;
     _width = 0;
     _height = 0;
     
+    _fontSize = DEFAULT_TEXT_SIZE;
     _font = NULL;
     
     _previousText = "";
@@ -16,32 +80,46 @@ TextBox::TextBox() {
 }
 
 TextBox::~TextBox() {
+    destroyTexture();
+}
+
+void TextBox::destroyTexture() {
     if (_renderedText) {
-        SDL_DestroyTexture(_renderedText);
-    }
-    
-    if (_font) {
-        TTF_CloseFont(_font);
+        numberOfTextTextures--;
+        textTextureBytes -= getTextureBytes(_renderedText);
+        
+        if (numberOfRetiredTextTextures == retiredTextTexturesCapacity) {
+            retiredTextTexturesCapacity = max(retiredTextTexturesCapacity * 2, 16);
+            
+            SDL_Texture **newTextures = new SDL_Texture *[retiredTextTexturesCapacity];
+            for (int i = 0; i < numberOfRetiredTextTextures; i++) {
+                newTextures[i] = retiredTextTextures[i];
+            }
+            
+            delete[] retiredTextTextures;
+            retiredTextTextures = newTextures;
+        }
+        
+        retiredTextTextures[numberOfRetiredTextTextures] = _renderedText;
+        numberOfRetiredTextTextures++;
+        
+        _renderedText = NULL;
     }
 }
 
-bool TextBox::initFont() {
-    return initFont(DEFAULT_TEXT_SIZE);
+void TextBox::initFont() {
+    initFont(DEFAULT_TEXT_SIZE);
 }
 
-bool TextBox::initFont(int fontSize) {
-    if (_font) {
-        TTF_CloseFont(_font);
-    }
-    
-    _font = TTF_OpenFont("font.ttf", fontSize);
-    
-    if (!_font) {
-        printf("Couldn't open font. Error: %s\n", TTF_GetError());
-        return false;
+void TextBox::initFont(int fontSize) {
+    if (fontSize != _fontSize) {
+        _fontSize = fontSize;
+        _font = NULL;
+        
+        // rerender at the new size
+        _previousText = "";
+        destroyTexture();
     }
-    
-    return true;
 }
 
 void TextBox::setColor(int r, int g, int b, int a) {
@@ -111,25 +189,37 @@ void TextBox::draw(SDL_Renderer *renderer) {
 }
 
 void TextBox::draw(SDL_Renderer *renderer, int x, int y) {
+    PROFILE_ZONE("TextBox::draw");
+    
     if (!_font) {
-        initFont(DEFAULT_TEXT_SIZE);
+        _font = getFont(_fontSize);
+        if (!_font) {
+            return;
+        }
     }
     
     if (_text != _previousText || !_renderedText) {
-        if (_renderedText) {
-            SDL_DestroyTexture(_renderedText);
-        }
+        destroyTexture();
         
 //        printf("_text: %s\n", _text.c_str());
         SDL_Surface *textSurface = TTF_RenderText_Blended(_font, _text.c_str(), _color);
         _renderedText = SDL_CreateTextureFromSurface(renderer, textSurface);
         SDL_FreeSurface(textSurface);
+        
+        if (_renderedText) {
+            numberOfTextTextures++;
+            textTextureBytes += getTextureBytes(_renderedText);
+        }
+        
+        // otherwise every draw until the next setText renders the same text again
+        _previousText = _text;
     }
     
     SDL_QueryTexture(_renderedText, NULL, NULL, &_width, &_height);
     
     SDL_Rect textRect = { x, y, _width, _height };
     SDL_RenderCopy(renderer, _renderedText, NULL, &textRect);
+    COUNT_STAT(DRAW_CALLS, 1);
 }
 
 TextSelection::TextSelection() {
@@ -179,6 +269,10 @@ int TextSelection::getSelection() {
     return _selection;
 }
 
+void TextSelection::setSelection(int selection) {
+    _selection = selection;
+}
+
 void TextSelection::resetSelection() {
     _selection = 0;
 }
@@ -203,9 +297,10 @@ void TextSelection::addOption(string text, int r, int g, int b, int a) {
             newText[i].setY(_text[i].getY());
             newText[i].setWidth(_text[i].getWidth());
             newText[i].setHeight(_text[i].getHeight());
+            newText[i].initFont(_fontSize);
         }
         
-        delete _text;
+        delete[] _text;
         _text = newText;
         _textCapacity *= 2;
     }
@@ -221,10 +316,12 @@ void TextSelection::clearOptions() {
 
 void TextSelection::setFontSize(int fontSize) {
     _fontSize = fontSize;
+    _selector.initFont(fontSize);
     
-    TTF_Font *testFont = TTF_OpenFont("font.ttf", fontSize);
-    _textHeight = TTF_FontHeight(testFont);
-    TTF_CloseFont(testFont);
+    TTF_Font *font = getFont(fontSize);
+    if (font) {
+        _textHeight = TTF_FontHeight(font);
+    }
 }
 
 void TextSelection::setPos(int x, int y) {
@@ -241,8 +338,6 @@ void TextSelection::setPos(int x, int y) {
 }
 
 int TextSelection::update(KeyboardLayout *keys) {
-    _selector.initFont(_fontSize);
-    
     if (_active) {
         if (keys->getUpState() == PRESSED) {
             _selection--;
@@ -361,6 +456,7 @@ void TextInput::draw(SDL_Renderer *renderer) {
     SDL_Rect backgroundRect = { _x, _y, _backgroundWidth, _backgroundHeight };
     SDL_SetRenderDrawColor(renderer, 0xFF, 0xFF, 0xFF, 0xFF);
     SDL_RenderFillRect(renderer, &backgroundRect);
+    COUNT_STAT(DRAW_CALLS, 1);
     
     _text.draw(renderer, _x + _textOffset, _y + _textOffset);
 //    printf("Error: %s\n", TTF_GetError());
@@ -403,4 +499,5 @@ void ColorBlock::draw(SDL_Renderer *renderer) {
     SDL_Rect blockRect = { _x, _y, _width, _height };
     SDL_SetRenderDrawColor(renderer, _color.r, _color.g, _color.b, _color.a);
     SDL_RenderFillRect(renderer, &blockRect);
+    COUNT_STAT(DRAW_CALLS, 1);
 }
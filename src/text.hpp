@@ -23,15 +23,29 @@
 #include "controls.hpp"
 using namespace std;
 
+class MemoryReport;
+
 const int DEFAULT_TEXT_SIZE = 32;
 
+// fonts are opened from the embedded font once per size and shared by every widget using that size
+TTF_Font *getFont(int fontSize);
+void closeFonts();
+
+// text boxes never destroy their textures themselves, since they may be changed on the simulation
+// thread. the render thread calls this, under the UI lock, to destroy the ones they've let go of
+void destroyRetiredTextTextures();
+
+// every text box's rendered texture and the open fonts, into the report's current section
+void reportTextMemory(MemoryReport *report);
+
 class TextBox {
 public:
     TextBox();
     ~TextBox();
     
-    bool initFont();
-    bool initFont(int fontSize);
+    // the font itself is only opened when the text is first drawn
+    void initFont();
+    void initFont(int fontSize);
     
     void setColor(int r, int g, int b, int a);
     void setText(string text);
@@ -57,10 +71,13 @@ public:
     void draw(SDL_Renderer *renderer, int x, int y);
     
 private:
+    void destroyTexture();
+    
     string _previousText;
     string _text;
     
     SDL_Color _color;
+    int _fontSize;
     TTF_Font *_font;
     SDL_Texture *_renderedText;
     
@@ -81,6 +98,7 @@ public:
     void setItemsToDisplay(int n);
     
     int getSelection();
+    void setSelection(int selection);
     void resetSelection();
     
     void addOption(string text, int r, int g, int b, int a);
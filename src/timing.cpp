@@ -0,0 +1,121 @@
+#include <algorithm>
+
+#include "timing.hpp"
+using namespace std;
+
+FramePacer::FramePacer() {
+    _frequency = SDL_GetPerformanceFrequency();
+    _targetTicks = _frequency / 60;
+    _nextFrame = 0;
+    _previousFrameEnd = 0;
+    
+    _vsync = false;
+    
+    _sampleIndex = 0;
+    _numberOfSamples = 0;
+}
+
+void FramePacer::setTargetFps(int fps) {
+    _targetTicks = _frequency / fps;
+}
+
+void FramePacer::setVsync(bool vsync) {
+    _vsync = vsync;
+}
+
+bool FramePacer::getVsync() {
+    return _vsync;
+}
+
+void FramePacer::beginFrame() {
+    Uint64 now = SDL_GetPerformanceCounter();
+    
+    // first frame, or we fell more than a frame behind: don't try to catch up with a burst of short frames
+    if (_nextFrame == 0 || now > _nextFrame + _targetTicks) {
+        _nextFrame = now;
+    }
+    
+    _nextFrame += _targetTicks;
+}
+
+void FramePacer::endFrame() {
+    if (!_vsync) {
+        Uint64 now = SDL_GetPerformanceCounter();
+        
+        if (now < _nextFrame) {
+            double remaining = ticksToMs(_nextFrame - now);
+            if (remaining > SPIN_MARGIN_MS) {
+                SDL_Delay(static_cast<Uint32>(remaining - SPIN_MARGIN_MS));
+            }
+            
+            while (SDL_GetPerformanceCounter() < _nextFrame) {
+                // spin out the last fraction of a millisecond
+            }
+        }
+    }
+    
+    Uint64 frameEnd = SDL_GetPerformanceCounter();
+    if (_previousFrameEnd != 0) {
+        _samples[_sampleIndex] = ticksToMs(frameEnd - _previousFrameEnd);
+        _sampleIndex = (_sampleIndex + 1) % FRAME_TIME_SAMPLES;
+        
+        if (_numberOfSamples < FRAME_TIME_SAMPLES) {
+            _numberOfSamples++;
+        }
+    }
+    _previousFrameEnd = frameEnd;
+}
+
+double FramePacer::getLastFrameTime() {
+    if (_numberOfSamples == 0) {
+        return 0;
+    }
+    
+    return _samples[(_sampleIndex + FRAME_TIME_SAMPLES - 1) % FRAME_TIME_SAMPLES];
+}
+
+double FramePacer::getP50() {
+    return percentile(0.5);
+}
+
+double FramePacer::getP99() {
+    return percentile(0.99);
+}
+
+double FramePacer::getMax() {
+    return percentile(1);
+}
+
+int FramePacer::getNumberOfSamples() {
+    return _numberOfSamples;
+}
+
+double FramePacer::getFrameTime(int age) {
+    if (age < 0 || age >= _numberOfSamples) {
+        return 0;
+    }
+    
+    return _samples[(_sampleIndex + FRAME_TIME_SAMPLES - 1 - age) % FRAME_TIME_SAMPLES];
+}
+
+double FramePacer::getTargetFrameTime() {
+    return ticksToMs(_targetTicks);
+}
+
+double FramePacer::percentile(double p) {
+    if (_numberOfSamples == 0) {
+        return 0;
+    }
+    
+    double sorted[FRAME_TIME_SAMPLES];
+    copy(_samples, _samples + _numberOfSamples, sorted);
+    
+    int i = static_cast<int>(p * (_numberOfSamples - 1) + 0.5);
+    nth_element(sorted, sorted + i, sorted + _numberOfSamples);
+    
+    return sorted[i];
+}
+
+double FramePacer::ticksToMs(Uint64 ticks) {
+    return ticks * 1000.0 / _frequency;
+}
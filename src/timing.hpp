@@ -0,0 +1,57 @@
+#ifndef timing_hpp
+#define timing_hpp
+
+#if defined __APPLE__ || defined __linux__
+#include <SDL2/SDL.h>
+#endif
+
+#ifdef _WIN64
+#include <SDL.h>
+#endif
+
+const int FRAME_TIME_SAMPLES = 240;
+
+// SDL_Delay can oversleep by a millisecond or two, so stop sleeping this early and spin the rest
+const double SPIN_MARGIN_MS = 2.0;
+
+class FramePacer {
+public:
+    FramePacer();
+    
+    void setTargetFps(int fps);
+    
+    // with vsync on SDL_RenderPresent already blocks, so the pacer only measures
+    void setVsync(bool vsync);
+    bool getVsync();
+    
+    void beginFrame();
+    void endFrame();
+    
+    // frame times in milliseconds over the last FRAME_TIME_SAMPLES frames
+    double getLastFrameTime();
+    double getP50();
+    double getP99();
+    double getMax();
+    int getNumberOfSamples();
+    
+    // 0 is the last frame, 1 the one before and so on, up to getNumberOfSamples() - 1
+    double getFrameTime(int age);
+    double getTargetFrameTime();
+    
+private:
+    double percentile(double p);
+    double ticksToMs(Uint64 ticks);
+    
+    Uint64 _frequency;
+    Uint64 _targetTicks;
+    Uint64 _nextFrame;
+    Uint64 _previousFrameEnd;
+    
+    bool _vsync;
+    
+    double _samples[FRAME_TIME_SAMPLES];
+    int _sampleIndex;
+    int _numberOfSamples;
+};
+
+#endif
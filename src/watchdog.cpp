@@ -0,0 +1,258 @@
+#include <algorithm>
+#include <stdio.h>
+#include <string.h>
+
+#include "watchdog.hpp"
+#include "game.hpp"
+
+// one zone name's share of a slow frame
+struct ZoneTotal {
+    const char *name;
+    double time;    // in milliseconds
+    int count;
+};
+
+bool compareZoneTotals(const ZoneTotal &a, const ZoneTotal &b) {
+    return a.time > b.time;
+}
+
+void getFrameContext(RenderSnapshot *snapshot, FrameContext *context) {
+    PlayerSnapshot *player = snapshot->getPlayer();
+    
+    context->gameState = snapshot->getGameState();
+    context->levelName = snapshot->getLevelName();
+    
+    context->playerX = player->x;
+    context->playerY = player->y;
+    context->velocityX = player->velocityX;
+    context->velocityY = player->velocityY;
+    
+    context->ropePivots = snapshot->getGrapple()->getNumberOfPivots();
+    context->platforms = snapshot->getLevel()->getNumberOfPlatforms();
+}
+
+FrameWatchdog::FrameWatchdog() {
+    _budget = 0;
+    _budgetTicks = 0;
+    
+    _thread = NULL;
+    _mutex = NULL;
+    _queueChanged = NULL;
+    
+    _lastReport = 0;
+    _skipped = 0;
+    _stopping = false;
+}
+
+FrameWatchdog::~FrameWatchdog() {
+    stop();
+}
+
+bool FrameWatchdog::start(string filename, double budget) {
+    _filename = filename;
+    _budget = budget;
+    
+    if (_budget <= 0) {
+        printf("Couldn't start frame watchdog. Error: the budget must be more than 0 ms\n");
+        return false;
+    }
+    
+    _mutex = SDL_CreateMutex();
+    _queueChanged = SDL_CreateCond();
+    if (!_mutex || !_queueChanged) {
+        printf("Couldn't create frame watchdog locks. Error: %s\n", SDL_GetError());
+        return false;
+    }
+    
+    _stopping = false;
+    
+    _thread = SDL_CreateThread(writeReports, "frame watchdog", this);
+    if (!_thread) {
+        printf("Couldn't create frame watchdog thread. Error: %s\n", SDL_GetError());
+        return false;
+    }
+    
+    // only once the thread is there to take the reports
+    _budgetTicks = static_cast<Uint64>(_budget * SDL_GetPerformanceFrequency() / 1000);
+    
+    return true;
+}
+
+void FrameWatchdog::stop() {
+    _budgetTicks = 0;
+    
+    if (_thread) {
+        SDL_LockMutex(_mutex);
+        _stopping = true;
+        SDL_CondSignal(_queueChanged);
+        SDL_UnlockMutex(_mutex);
+        
+        SDL_WaitThread(_thread, NULL);
+        _thread = NULL;
+    }
+    
+    SDL_DestroyCond(_queueChanged);
+    SDL_DestroyMutex(_mutex);
+    _queueChanged = NULL;
+    _mutex = NULL;
+}
+
+bool FrameWatchdog::isOverBudget(Uint64 frameStart, Uint64 frameEnd) {
+    return _budgetTicks > 0 && frameEnd - frameStart > _budgetTicks;
+}
+
+void FrameWatchdog::report(const char *loop, Uint64 frameStart, Uint64 frameEnd, FrameContext *context) {
+    if (!_thread) {
+        return;
+    }
+    
+    Uint64 frequency = SDL_GetPerformanceFrequency();
+    
+    SDL_LockMutex(_mutex);
+    
+    if (_lastReport != 0 && frameEnd - _lastReport < static_cast<Uint64>(MIN_SLOW_FRAME_REPORT_INTERVAL * frequency)) {
+        _skipped++;
+        SDL_UnlockMutex(_mutex);
+        return;
+    }
+    
+    _lastReport = frameEnd;
+    int skipped = _skipped;
+    _skipped = 0;
+    
+    SDL_UnlockMutex(_mutex);
+    
+    SlowFrame frame;
+    frame.loop = loop;
+    frame.frameTime = (frameEnd - frameStart) * 1000.0 / frequency;
+    frame.when = time(NULL);
+    frame.skipped = skipped;
+    frame.context = *context;
+    
+    // the zones have to be taken now, before the profiler's rings wrap round over them. the other
+    // threads may have finished some since the frame did
+    collectProfileEvents(frameStart, &frame.zones);
+    
+    size_t kept = 0;
+    for (size_t i = 0; i < frame.zones.size(); i++) {
+        if (frame.zones[i].end <= frameEnd) {
+            frame.zones[kept] = frame.zones[i];
+            kept++;
+        }
+    }
+    frame.zones.resize(kept);
+    
+    SDL_LockMutex(_mutex);
+    _queue.push_back(frame);
+    SDL_CondSignal(_queueChanged);
+    SDL_UnlockMutex(_mutex);
+}
+
+string FrameWatchdog::formatReport(SlowFrame *frame) {
+    char line[512];
+    string report;
+    
+    char when[32];
+    strftime(when, sizeof(when), "%Y-%m-%d %H:%M:%S", localtime(&frame->when));
+    
+    snprintf(line, sizeof(line), "%s slow %s frame: %.2f ms, budget %.2f ms", when, frame->loop, frame->frameTime, _budget);
+    report += line;
+    
+    if (frame->skipped > 0) {
+        snprintf(line, sizeof(line), " (%d more since the last report)", frame->skipped);
+        report += line;
+    }
+    report += '\n';
+    
+    FrameContext *context = &frame->context;
+    const char *gameState = context->gameState >= 0 && context->gameState <= LEVEL_RESET ? GAME_MODE_STRINGS[context->gameState].c_str() : "?";
+    
+    snprintf(line, sizeof(line), "    state %s, level %s, player at %.1f, %.1f moving %.2f, %.2f, %d rope pivots, %d platforms\n",
+             gameState, context->levelName.empty() ? "(none)" : context->levelName.c_str(), context->playerX, context->playerY, context->velocityX, context->velocityY, context->ropePivots, context->platforms);
+    report += line;
+
+#ifdef UMIHARA_PROFILING
+    // added up by name; nested zones are counted in their parents as well
+    vector<ZoneTotal> totals;
+    double frequency = SDL_GetPerformanceFrequency() / 1000.0;
+    
+    for (size_t i = 0; i < frame->zones.size(); i++) {
+        ProfileEvent *zone = &frame->zones[i];
+        
+        size_t j = 0;
+        while (j < totals.size() && strcmp(totals[j].name, zone->name) != 0) {
+            j++;
+        }
+        
+        if (j == totals.size()) {
+            ZoneTotal total;
+            total.name = zone->name;
+            total.time = 0;
+            total.count = 0;
+            totals.push_back(total);
+        }
+        
+        totals[j].time += (zone->end - zone->start) / frequency;
+        totals[j].count++;
+    }
+    
+    sort(totals.begin(), totals.end(), compareZoneTotals);
+    
+    report += "    zones:";
+    if (totals.empty()) {
+        report += " none recorded";
+    }
+    
+    for (size_t i = 0; i < totals.size() && i < SLOW_FRAME_ZONES; i++) {
+        if (totals[i].count > 1) {
+            snprintf(line, sizeof(line), "%s %s %.2f ms x%d", i > 0 ? "," : "", totals[i].name, totals[i].time, totals[i].count);
+        } else {
+            snprintf(line, sizeof(line), "%s %s %.2f ms", i > 0 ? "," : "", totals[i].name, totals[i].time);
+        }
+        report += line;
+    }
+    report += '\n';
+#else
+    report += "    zones: not recorded, built without UMIHARA_PROFILING\n";
+#endif
+    
+    return report;
+}
+
+int FrameWatchdog::writeReports(void *data) {
+    FrameWatchdog *watchdog = static_cast<FrameWatchdog *>(data);
+    
+    SDL_LockMutex(watchdog->_mutex);
+    while (true) {
+        while (watchdog->_queue.empty() && !watchdog->_stopping) {
+            SDL_CondWait(watchdog->_queueChanged, watchdog->_mutex);
+        }
+        
+        // only stop once everything queued has been written
+        if (watchdog->_queue.empty()) {
+            break;
+        }
+        
+        SlowFrame frame = watchdog->_queue.front();
+        watchdog->_queue.pop_front();
+        
+        SDL_UnlockMutex(watchdog->_mutex);
+        
+        string report = watchdog->formatReport(&frame);
+        
+        // opened for each report, so the log can be moved or deleted while the game runs
+        FILE *log = fopen(watchdog->_filename.c_str(), "a");
+        if (!log || fputs(report.c_str(), log) < 0 || fflush(log) != 0) {
+            printf("Couldn't append to %s\n", watchdog->_filename.c_str());
+        }
+        
+        if (log) {
+            fclose(log);
+        }
+        
+        SDL_LockMutex(watchdog->_mutex);
+    }
+    SDL_UnlockMutex(watchdog->_mutex);
+    
+    return 0;
+}
@@ -0,0 +1,98 @@
+#ifndef watchdog_hpp
+#define watchdog_hpp
+
+#if defined __APPLE__ || defined __linux__
+#include <SDL2/SDL.h>
+#endif
+
+#ifdef _WIN64
+#include <SDL.h>
+#endif
+
+#include <deque>
+#include <string>
+#include <time.h>
+#include <vector>
+using namespace std;
+
+#include "snapshot.hpp"
+#include "profiler.hpp"
+
+const string SLOW_FRAME_LOG_FILENAME = "slow_frames.log";
+
+// a frame that runs long every time would fill the log, so there's at most one report this often.
+// the ones in between are counted in the next report
+const double MIN_SLOW_FRAME_REPORT_INTERVAL = 1.0;     // in seconds
+
+// the most expensive zones a report lists
+const int SLOW_FRAME_ZONES = 12;
+
+// what the game was doing around a frame, copied out of a snapshot
+struct FrameContext {
+    int gameState;
+    string levelName;
+    
+    double playerX;
+    double playerY;
+    double velocityX;
+    double velocityY;
+    
+    int ropePivots;
+    int platforms;
+};
+
+void getFrameContext(RenderSnapshot *snapshot, FrameContext *context);
+
+// one report waiting to be written
+struct SlowFrame {
+    const char *loop;
+    double frameTime;   // in milliseconds
+    time_t when;
+    int skipped;        // slow frames since the last report that didn't get one
+    
+    FrameContext context;
+    
+    // every zone that ended during the frame, on any thread
+    vector<ProfileEvent> zones;
+};
+
+// notices frames that go over a time budget and appends a short report on each to a log file: the
+// profiling zones recorded during the frame (with UMIHARA_PROFILING) and what the game was doing.
+// frames within the budget cost one comparison; the reports are formatted and written on a background thread
+class FrameWatchdog {
+public:
+    FrameWatchdog();
+    ~FrameWatchdog();
+    
+    // budget is in milliseconds
+    bool start(string filename, double budget);
+    
+    // writes any reports still queued
+    void stop();
+    
+    // always false until started
+    bool isOverBudget(Uint64 frameStart, Uint64 frameEnd);
+    
+    // from any thread. loop names the loop the frame belongs to ("render", say)
+    void report(const char *loop, Uint64 frameStart, Uint64 frameEnd, FrameContext *context);
+    
+private:
+    static int writeReports(void *data);
+    string formatReport(SlowFrame *frame);
+    
+    string _filename;
+    double _budget;
+    Uint64 _budgetTicks;
+    
+    SDL_Thread *_thread;
+    SDL_mutex *_mutex;
+    SDL_cond *_queueChanged;
+    
+    // guarded by _mutex
+    deque<SlowFrame> _queue;
+    Uint64 _lastReport;
+    int _skipped;
+    bool _stopping;
+};
+
+#endif
@@ -0,0 +1,271 @@
+// checks level loading against small files written on the spot, into levels/ under the working directory
+//
+//     level_test
+
+#include <filesystem>
+#include <fstream>
+#include <stdio.h>
+#include <string>
+using namespace std;
+
+#include "level.hpp"
+#include "generator.hpp"
+#include "memory.hpp"
+
+int failures = 0;
+
+void check(bool condition, const char *description) {
+    if (!condition) {
+        printf("FAILED: %s\n", description);
+        failures++;
+    }
+}
+
+void writeLevel(string name, string contents) {
+    filesystem::create_directories("levels");
+    
+    ofstream file("levels/" + name + ".lvl", ios::binary);
+    file << contents;
+}
+
+void testRunLengthLevel() {
+    Level level;
+    
+    writeLevel("test_run_length", "D\n1 0 6*3 2\n3*4\n");
+    check(level.loadLevel("test_run_length"), "a run-length level loads");
+    check(level.getNumberOfPlatforms() == 7, "a run-length level loads every platform in its runs");
+    check(level.getPlatform(0)->getType() == 3, "a run-length tile of '6' is a lava platform");
+}
+
+void testRunLengthTileOutOfRange() {
+    Level level;
+    
+    // '9' would be platform type 6, past the last one
+    writeLevel("test_bad_tile", "D\n1 0 9*3 2\n3*6\n");
+    check(!level.loadLevel("test_bad_tile"), "a run-length level with a tile past the last platform type doesn't load");
+    check(level.getNumberOfPlatforms() == 0, "a run-length level with a tile past the last platform type loads no platforms");
+}
+
+void testBadLevelAfterGoodOne() {
+    Level level;
+    
+    writeLevel("test_good", "A\n1002\n3333\n");
+    check(level.loadLevel("test_good"), "a text level loads");
+    check(level.getNumberOfPlatforms() == 4, "a text level loads every platform");
+    
+    // nothing of the good level may be left to play under the bad one's name
+    writeLevel("test_bad", "A\n1002\n33x3\n");
+    check(!level.loadLevel("test_bad"), "a text level with a bad tile doesn't load");
+    check(level.getNumberOfPlatforms() == 0, "a level that failed to load has no platforms left");
+    check(level.getContentHash() == 0, "a level that failed to load has no content hash left");
+}
+
+void testMissingLevel() {
+    Level level;
+    
+    writeLevel("test_good", "A\n1002\n3333\n");
+    level.loadLevel("test_good");
+    Uint64 contentHash = level.getContentHash();
+    
+    check(!level.loadLevel("test_missing"), "a level that isn't there doesn't load");
+    check(level.getNumberOfPlatforms() == 4 && level.getContentHash() == contentHash, "a level that isn't there leaves the last one as it was");
+}
+
+// searches every platform, since a streamed level's aren't in its tile index
+int findPlatform(Level *level, int x, int y) {
+    for (int i = 0; i < level->getNumberOfPlatforms(); i++) {
+        if (level->getPlatform(i)->getX() == x && level->getPlatform(i)->getY() == y) {
+            return i;
+        }
+    }
+    
+    return -1;
+}
+
+bool sameGeometry(Level *a, Level *b) {
+    if (a->getNumberOfPlatforms() != b->getNumberOfPlatforms()) {
+        return false;
+    }
+    
+    for (int i = 0; i < a->getNumberOfPlatforms(); i++) {
+        Platform *platform = a->getPlatform(i);
+        int j = findPlatform(b, platform->getX(), platform->getY());
+        if (j < 0 || b->getPlatform(j)->getType() != platform->getType()) {
+            return false;
+        }
+    }
+    
+    return a->getStartX() == b->getStartX() && a->getStartY() == b->getStartY() && a->getEndX() == b->getEndX() && a->getEndY() == b->getEndY();
+}
+
+void testCopyEdits() {
+    Level level;
+    Level copy;
+    
+    writeLevel("test_good", "A\n1002\n3333\n");
+    level.loadLevel("test_good");
+    copy.copyGeometry(&level);
+    check(sameGeometry(&level, &copy), "a copied level has the same geometry");
+    
+    // the editor's edits: remove, change type, add and move the end
+    level.removePlatform(level.platformExists(0, PLATFORM_HEIGHT));
+    int changed = level.platformExists(2 * PLATFORM_WIDTH, PLATFORM_HEIGHT);
+    level.removePlatform(changed);
+    level.addPlatform(2 * PLATFORM_WIDTH, PLATFORM_HEIGHT, PLATFORM_WIDTH, PLATFORM_HEIGHT, 1);
+    level.addPlatform(PLATFORM_WIDTH, 0, PLATFORM_WIDTH, PLATFORM_HEIGHT, 2);
+    level.setEndPos(PLATFORM_WIDTH, 2 * PLATFORM_HEIGHT);
+    
+    copy.copyGeometry(&level);
+    check(sameGeometry(&level, &copy), "a copy catches up with a few edits");
+    check(copy.platformExists(0, PLATFORM_HEIGHT) < 0, "a copy's tile index loses a removed platform");
+    check(copy.getPlatform(copy.platformExists(2 * PLATFORM_WIDTH, PLATFORM_HEIGHT))->getType() == 1, "a copy's tile index finds a changed platform");
+    
+    // more edits than the log holds
+    for (int i = 0; i < 100; i++) {
+        level.addPlatform((4 + i) * PLATFORM_WIDTH, 0, PLATFORM_WIDTH, PLATFORM_HEIGHT, 0);
+    }
+    
+    copy.copyGeometry(&level);
+    check(sameGeometry(&level, &copy), "a copy catches up with more edits than the log holds");
+}
+
+// more than a chunk across, so the converted level has padded edge chunks
+string wideTextLevel() {
+    string contents = "A\n1";
+    for (int x = 1; x < 129; x++) {
+        contents += x % 3 == 0 ? '0' : static_cast<char>('3' + x % 4);
+    }
+    contents += "2\n";
+    
+    for (int x = 0; x < 130; x++) {
+        contents += '3';
+    }
+    contents += '\n';
+    
+    return contents;
+}
+
+void testChunkedLevel() {
+    Level original;
+    Level chunked;
+    
+    writeLevel("test_wide", wideTextLevel());
+    check(original.loadLevel("test_wide") && original.getNumberOfPlatforms() == 216, "a wide text level loads every platform");
+    original.saveLevel("test_binary", NULL);
+    check(original.loadLevel("test_binary"), "a binary level loads");
+    
+    original.saveChunkedLevel("test_chunked", NULL);
+    check(chunked.loadLevel("test_chunked"), "a chunked level loads");
+    check(chunked.isStreaming(), "a chunked level is streamed");
+    
+    chunked.requireArea(0, 0, chunked.getMaxX() + 1, chunked.getMaxY() + 1);
+    check(sameGeometry(&original, &chunked), "a chunked level streams in the binary level it was saved from");
+    check(chunked.getContentHash() == original.getContentHash(), "a chunked level has the binary level's content hash");
+}
+
+void testRunLengthRoundTrip() {
+    Level original;
+    Level saved;
+    
+    writeLevel("test_wide", wideTextLevel());
+    original.loadLevel("test_wide");
+    
+    original.saveRunLengthLevel("test_run_length_saved", NULL);
+    check(saved.loadLevel("test_run_length_saved"), "a saved run-length level loads");
+    check(sameGeometry(&original, &saved), "a saved run-length level has the platforms and start/end it was saved with");
+    check(saved.getContentHash() == original.getContentHash(), "a saved run-length level keeps its content hash");
+}
+
+void testReadSummary() {
+    Level level;
+    int width;
+    int height;
+    Uint64 contentHash;
+    
+    // a text level has to be loaded to hash it, a binary one has the hash in its header
+    writeLevel("test_wide", wideTextLevel());
+    level.loadLevel("test_wide");
+    check(Level::readSummary("test_wide", &width, &height, &contentHash) && width == 130 && contentHash == level.getContentHash(), "a text level's summary has its size and content hash");
+    int textHeight = height;
+    
+    level.saveLevel("test_binary", NULL);
+    check(Level::readSummary("test_binary", &width, &height, &contentHash) && width == 130 && contentHash == level.getContentHash(), "a binary level's summary has its size and content hash");
+    check(height == textHeight, "a binary level's summary is the same size as the text level it was saved from");
+    
+    check(!Level::readSummary("test_missing", &width, &height, &contentHash), "a level that isn't there has no summary");
+}
+
+string readLevel(string name) {
+    ifstream file("levels/" + name + ".lvl", ios::binary);
+    return string(istreambuf_iterator<char>(file), istreambuf_iterator<char>());
+}
+
+void testGeneratedLevel() {
+    LevelGeneratorSettings settings;
+    setDefaultGeneratorSettings(&settings);
+    settings.seed = 1234;
+    
+    // from a directory with no levels/ in it yet, like a fresh build
+    filesystem::path workingDirectory = filesystem::current_path();
+    filesystem::remove_all("test_generator");
+    filesystem::create_directories("test_generator");
+    filesystem::current_path("test_generator");
+    
+    check(generateLevelFile("test_generated", &settings), "a level is generated where there's no levels directory yet");
+    check(generateLevelFile("test_generated_again", &settings), "a level is generated again");
+    
+    string contents = readLevel("test_generated");
+    check(!contents.empty() && contents == readLevel("test_generated_again"), "the same seed generates the same bytes");
+    
+    settings.seed = 1235;
+    generateLevelFile("test_generated_other", &settings);
+    check(contents != readLevel("test_generated_other"), "another seed generates another level");
+    
+    // the file and the in-memory level are the same level
+    Level loaded;
+    Level generated;
+    settings.seed = 1234;
+    check(loaded.loadLevel("test_generated") && generateLevel(&generated, &settings), "a generated level loads");
+    check(sameGeometry(&loaded, &generated) && loaded.getContentHash() == generated.getContentHash(), "a generated file holds the level generated in memory");
+    
+    filesystem::current_path(workingDirectory);
+    filesystem::remove_all("test_generator");
+}
+
+void testLevelMemoryAfterBiggerLevel() {
+    Level reused;
+    Level fresh;
+    
+    writeLevel("test_wide", wideTextLevel());
+    writeLevel("test_good", "A\n1002\n3333\n");
+    reused.loadLevel("test_wide");
+    reused.loadLevel("test_good");
+    fresh.loadLevel("test_good");
+    
+    MemoryReport reusedMemory;
+    MemoryReport freshMemory;
+    reused.reportMemory(&reusedMemory);
+    fresh.reportMemory(&freshMemory);
+    check(reusedMemory.getTotalAllocated() == freshMemory.getTotalAllocated(), "a level holds no more memory after a bigger one than it would on its own");
+}
+
+int main() {
+    testRunLengthLevel();
+    testRunLengthTileOutOfRange();
+    testBadLevelAfterGoodOne();
+    testMissingLevel();
+    testCopyEdits();
+    testChunkedLevel();
+    testRunLengthRoundTrip();
+    testReadSummary();
+    testGeneratedLevel();
+    testLevelMemoryAfterBiggerLevel();
+    
+    if (failures > 0) {
+        printf("%d check%s failed\n", failures, failures == 1 ? "" : "s");
+        return 1;
+    }
+    
+    printf("all checks passed\n");
+    return 0;
+}